@@ -3,6 +3,53 @@ TARGET = Insta_C2_Simulation
 CONFIG += console c++17
 CONFIG -= app_bundle
 CONFIG -= qt
+CONFIG += thread
+
+# Determinism: never fuse a*b+c into FMA. The SIMD kernels and the scalar fallback must round identically.
+!msvc: QMAKE_CXXFLAGS += -ffp-contract=off
+
+# Debug builds abort on any heap allocation in the steady-state loop (see alloc_guard.h).
+CONFIG(debug, debug|release): DEFINES += SIM_ALLOC_GUARD
+
+# qmake CONFIG+=fixed_point: Q32.32 integer state instead of double (see numeric.h). Hashes and
+# snapshots differ between the two modes; every replica of a lockstep session must use the same one.
+fixed_point: DEFINES += SIM_FIXED_POINT
 
 SOURCES += \
-    main.cpp
+    alloc_guard.cpp \
+    clock.cpp \
+    command_pipeline.cpp \
+    frame_pacer.cpp \
+    frame_stats.cpp \
+    integrator.cpp \
+    interest.cpp \
+    job_system.cpp \
+    journal.cpp \
+    main.cpp \
+    presentation.cpp \
+    simulation.cpp \
+    snapshot.cpp \
+    state_hash.cpp \
+    telemetry.cpp \
+    trace.cpp
+
+HEADERS += \
+    alloc_guard.h \
+    arena.h \
+    clock.h \
+    command_pipeline.h \
+    command_queue.h \
+    engine.h \
+    frame_pacer.h \
+    frame_stats.h \
+    integrator.h \
+    interest.h \
+    job_system.h \
+    journal.h \
+    numeric.h \
+    presentation.h \
+    simulation.h \
+    snapshot.h \
+    state_hash.h \
+    telemetry.h \
+    trace.h
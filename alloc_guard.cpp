@@ -0,0 +1,84 @@
+#include "alloc_guard.h"
+
+#ifdef SIM_ALLOC_GUARD
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <unistd.h>
+
+namespace {
+
+thread_local bool armed = false;                 // Trivially initialized: safe to read inside operator new.
+
+[[noreturn]] void allocationViolation(std::size_t size) {
+    armed = false;                               // Whatever runs next (abort handlers, sanitizers) may allocate.
+    char message[128];
+    int length = std::snprintf(message, sizeof(message),
+                               "alloc guard: %zu-byte allocation inside the steady-state loop\n", size);
+    if (length > 0) {
+        ssize_t ignored = ::write(2, message, static_cast<size_t>(length)); // Raw write: stdio might allocate.
+        (void)ignored;
+    }
+    std::abort();                                // Loud on purpose: the core dump's stack names the caller.
+}
+
+void* allocate(std::size_t size) {
+    if (armed) allocationViolation(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* allocateAligned(std::size_t size, std::align_val_t alignment) {
+    if (armed) allocationViolation(size);
+    const std::size_t align = static_cast<std::size_t>(alignment);
+    const std::size_t rounded = (size + align - 1) / align * align; // aligned_alloc wants a multiple.
+    if (void* p = std::aligned_alloc(align, rounded ? rounded : align)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+AllocationGuard::AllocationGuard() {
+    armed = true;
+}
+
+AllocationGuard::~AllocationGuard() {
+    armed = false;
+}
+
+AllocationPermit::AllocationPermit() : wasArmed_(armed) {
+    armed = false;
+}
+
+AllocationPermit::~AllocationPermit() {
+    armed = wasArmed_;
+}
+
+// Replacements for the global allocation functions. The array and nothrow forms forward to these in
+// libstdc++/libc++, so the four below cover every new-expression.
+void* operator new(std::size_t size) {
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+#endif // SIM_ALLOC_GUARD
@@ -0,0 +1,50 @@
+#ifndef ALLOC_GUARD_H
+#define ALLOC_GUARD_H
+
+// Debug check for the zero-allocation guarantee of the steady-state loop.
+//
+// Built with SIM_ALLOC_GUARD (debug configurations; see the .pro), global operator new is replaced by
+// a version that aborts with a message when the calling thread is armed. The loops arm the sim thread
+// once warm-up is over (first-use allocations such as presentation buffers and trace rings are done),
+// so any allocation after that is a bug found on the spot, with a core dump pointing at the caller.
+// AllocationPermit marks the few deliberate exceptions (on-demand dumps) in the loop.
+//
+// Without SIM_ALLOC_GUARD both classes are empty and operator new is untouched.
+// Only the arming thread is checked; pool workers run kernels that never allocate.
+
+#ifdef SIM_ALLOC_GUARD
+
+class AllocationGuard {                          // Arms the calling thread for its lifetime.
+public:
+    AllocationGuard();
+    ~AllocationGuard();
+    AllocationGuard(const AllocationGuard&) = delete;
+    AllocationGuard& operator=(const AllocationGuard&) = delete;
+};
+
+class AllocationPermit {                         // Disarms the calling thread for its lifetime.
+public:
+    AllocationPermit();
+    ~AllocationPermit();
+    AllocationPermit(const AllocationPermit&) = delete;
+    AllocationPermit& operator=(const AllocationPermit&) = delete;
+
+private:
+    bool wasArmed_;
+};
+
+#else
+
+class AllocationGuard {
+public:
+    AllocationGuard() {}
+};
+
+class AllocationPermit {
+public:
+    AllocationPermit() {}
+};
+
+#endif // SIM_ALLOC_GUARD
+
+#endif // ALLOC_GUARD_H
@@ -0,0 +1,56 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+// Bump allocator for per-tick scratch data. One buffer is allocated up front; allocate() is a pointer
+// bump, and reset() at the start of every tick releases everything at once. Nothing is destroyed:
+// only trivially destructible data belongs here (command batches, index lists, temporary arrays).
+//
+// Exhaustion returns nullptr instead of growing. The capacity is a budget: running out means a
+// caller's worst case was sized wrong, and growing inside the loop is exactly the jitter this avoids.
+// highWater() shows how close the worst tick came.
+
+class FrameArena {
+public:
+    explicit FrameArena(size_t capacity)
+        : buffer_(new unsigned char[capacity]), capacity_(capacity) {
+    }
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(buffer_.get());
+        const uintptr_t aligned = (base + used_ + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+        const size_t end = static_cast<size_t>(aligned - base) + size;
+        if (end > capacity_) return nullptr;
+        used_ = end;
+        if (used_ > highWater_) highWater_ = used_;
+        return reinterpret_cast<void*>(aligned);
+    }
+
+    template <typename T>
+    T* allocateArray(size_t count) {             // Uninitialized storage for count Ts.
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is released without destructors");
+        return static_cast<T*>(allocate(count * sizeof(T), alignof(T)));
+    }
+
+    void reset() { used_ = 0; }                  // Start of tick: everything handed out before is dead.
+
+    size_t used() const { return used_; }
+    size_t capacity() const { return capacity_; }
+    size_t highWater() const { return highWater_; }
+
+private:
+    std::unique_ptr<unsigned char[]> buffer_;
+    size_t capacity_;
+    size_t used_ = 0;
+    size_t highWater_ = 0;
+};
+
+#endif // ARENA_H
@@ -0,0 +1,280 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+#include "../clock.h"
+#include "../command_pipeline.h"
+#include "../engine.h"
+#include "../integrator.h"
+#include "../simulation.h"
+
+// Microbenchmarks for the engine hot paths. One line per (function, size):
+//   ns/item     wall time per entity (or per command for the queue benches)
+//   Mitems/s    throughput
+//   miss/item   hardware cache misses (PERF_COUNT_HW_CACHE_MISSES, usually LLC) per item;
+//               "n/a" where perf_event_open is not permitted (containers, perf_event_paranoid > 2).
+// Sizes sweep 1..10M entities, so the curve shows where each kernel falls out of L1, L2, LLC.
+// Usage: benchmarks [FILTER] [--max ENTITIES]   (FILTER is a substring of the benchmark name)
+// Build with the same flags as the engine (benchmarks.pro does), or the numbers mean nothing.
+
+namespace {
+
+const size_t MAX_ENTITIES = 10000000;
+const uint64_t TARGET_ITEMS = 50000000;          // Work per measurement: ~tens of ms at typical speeds.
+const uint64_t MIN_ITERATIONS = 5;
+const int REPEATS = 3;                           // Report the fastest of several runs: least disturbed by noise.
+
+class CacheMissCounter {                         // One perf counter for this thread; inert if unavailable.
+public:
+    CacheMissCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+        if (fd_ >= 0) close(fd_);
+    }
+
+    bool available() const { return fd_ >= 0; }
+    void start() {
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    uint64_t stop() {
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) return 0;
+        return count;
+    }
+
+private:
+    int fd_ = -1;
+};
+
+CacheMissCounter cacheMisses;
+
+// A second engine configuration, next to the one main() uses: 60 Hz ticks, a looser clamp, and a
+// concrete clock so nowNs() inlines. Idle: no commands, no hash.
+struct BenchEngineConfig {
+    static constexpr double FIXED_DT_SECONDS = 1.0 / 60.0;
+    static constexpr double MAX_DT_SECONDS = 0.25;
+    static constexpr int MAX_STEPS_PER_FRAME = 8;
+};
+
+struct NoCommands {
+    struct Batch {};
+    Batch drain(uint64_t) { return Batch{}; }
+};
+
+struct IdleStep {
+    void step(SimulationState& sim, NoCommands::Batch) { stepSimulation(sim, nullptr, 0, nullptr, 0); }
+};
+
+using BenchEngine = SimulationEngine<SimulationState, IdleStep, NoCommands, VirtualClock, BenchEngineConfig>;
+
+struct Result {
+    double nsPerItem;
+    double missesPerItem;
+};
+
+template <typename Body>
+Result measure(uint64_t iterations, uint64_t itemsPerIteration, Body body) {
+    body();                                      // Warm-up: page faults, first-touch, branch predictors.
+    Result best{1e300, 0.0};
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        cacheMisses.start();
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) body();
+        auto end = std::chrono::steady_clock::now();
+        uint64_t misses = cacheMisses.stop();
+        const double items = static_cast<double>(iterations * itemsPerIteration);
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count() / items;
+        if (ns < best.nsPerItem) best = Result{ns, static_cast<double>(misses) / items};
+    }
+    return best;
+}
+
+void report(const char* name, size_t count, const Result& result) {
+    char misses[32];
+    if (cacheMisses.available()) std::snprintf(misses, sizeof(misses), "%.4f", result.missesPerItem);
+    else std::snprintf(misses, sizeof(misses), "n/a");
+    std::printf("%-18s %10zu %10.3f %12.1f %10s\n", name, count, result.nsPerItem, 1e3 / result.nsPerItem, misses);
+    std::fflush(stdout);
+}
+
+uint64_t iterationsFor(size_t items) {
+    uint64_t iterations = TARGET_ITEMS / (items ? items : 1);
+    return iterations < MIN_ITERATIONS ? MIN_ITERATIONS : iterations;
+}
+
+bool selected(const char* filter, const char* name) {
+    return !filter || std::strstr(name, filter) != nullptr;
+}
+
+void benchEntities(const char* filter, size_t count) {
+    EntityStore current(count, SystemState{1.0, 1.0, true});
+    const uint64_t iterations = iterationsFor(count);
+
+    if (selected(filter, "updateSystem")) {
+        // Tiny dt keeps positions positive, so every entity stays on the valid path for all iterations.
+        report("updateSystem", count, measure(iterations, count, [&] { updateSystem(current, 1e-9); }));
+    }
+    if (selected(filter, "applyCommand")) {
+        const Command accelerate{CommandType::Accelerate, 1e-9};
+        report("applyCommand", count, measure(iterations, count, [&] { applyCommand(current, accelerate); }));
+    }
+    if (selected(filter, "interpolateState")) {
+        EntityStore previous = current;
+        EntityStore visual;
+        report("interpolateState", count,
+               measure(iterations, count, [&] { interpolateState(previous, current, 0.5, visual); }));
+    }
+    if (selected(filter, "stepSimulation")) {
+        SimulationState sim(current);            // Full fixed step: ping-pong kernel pass plus hash.
+        sim.hashEnabled = true;
+        report("stepSimulation", count, measure(iterations, count, [&] { stepSimulation(sim, nullptr, 0, nullptr, 0); }));
+    }
+    if (selected(filter, "stepHalfSettled")) {
+        // Every other 64K-entity range is dead (invalid in both buffers; smaller worlds are all live).
+        // Cost is per world entity, so the gap to stepSimulation is the saving from compaction.
+        EntityStore half = current;
+        for (size_t i = 0; i < count; ++i) half.valid[i] = (i >> 16) % 2 == 0 ? 1 : 0;
+        SimulationState sim(half);
+        sim.hashEnabled = true;
+        report("stepHalfSettled", count, measure(iterations, count, [&] { stepSimulation(sim, nullptr, 0, nullptr, 0); }));
+    }
+    if (selected(filter, "stepFastForward")) {
+        // Idle world, no hash: blocks are deferred and replayed in cache when a reader syncs, here every
+        // 64 ticks. Per entity and tick, so it compares directly with stepSimulation.
+        const uint64_t ticks = 64;
+        SimulationState sim(current);
+        sim.fastForward = true;
+        report("stepFastForward", count, measure(iterations / ticks + 1, count * ticks, [&] {
+            for (uint64_t tick = 0; tick < ticks; ++tick) stepSimulation(sim, nullptr, 0, nullptr, 0);
+            syncState(sim);
+        }));
+    }
+    if (selected(filter, "engineFrame")) {
+        // One frame of BenchEngine: measure, clamp and one 60 Hz tick. Compare with stepSimulation; the
+        // difference is the frame loop's own cost.
+        SimulationState sim(current);
+        IdleStep integrator;
+        NoCommands commands;
+        VirtualClock clock;
+        BenchEngine engine(sim, integrator, commands, clock);
+        engine.start();
+        report("engineFrame", count, measure(iterations, count, [&] {
+            clock.advance(BenchEngine::FIXED_DT_NS); // Exactly one tick of time per frame.
+            engine.advanceFrame();
+        }));
+    }
+    if (selected(filter, "interpolateSubset")) {
+        // A watch-list: every 100th entity, isolated (the scalar path). Cost is per world entity, so
+        // the gap to interpolateState is the saving from interest management.
+        EntityStore previous = current;
+        EntityStore visual(count, SystemState{});
+        std::vector<uint32_t> watched;
+        for (size_t i = 0; i < count; i += 100) watched.push_back(static_cast<uint32_t>(i));
+        report("interpolateSubset", count, measure(iterations, count, [&] {
+            interpolateSubset(previous, current, 0.5, watched.data(), watched.size(), visual);
+        }));
+    }
+}
+
+void benchQueue(const char* filter) {
+    // One tick's worth of input through the real pipeline, as main's enqueueCommand/drainCommands run it.
+    // Push: a full broadcast ring (enqueueCommand's tryPush) plus targeted commands spread over every
+    // partition (CommandRouter::enqueue); a quarter of each are stamped two ticks ahead. Drain: the same
+    // drainCommands() main's tick loop calls (command_pipeline.h), inline. The phases are timed
+    // separately per tick; the two clock reads per phase add well under 1 ns/command at this burst size.
+    if (!selected(filter, "enqueueCommand") && !selected(filter, "drainCommands")) return;
+    static CommandQueue queue;
+    static CommandScheduler scheduler;
+    static CommandRouter router;
+    router.configure(ENTITY_COUNT);
+    const size_t broadcasts = MAX_COMMAND_QUEUE_SIZE;
+    const size_t targetedPerPartition = 4;
+    const size_t burst = broadcasts + COMMAND_PARTITIONS * targetedPerPartition;
+    const size_t partitionSpan = ENTITY_COUNT / COMMAND_PARTITIONS;
+    const uint64_t iterations = iterationsFor(burst);
+    std::vector<Command> released(MAX_RELEASED_COMMANDS_PER_STEP);
+    std::vector<Command> batch(MAX_APPLIED_COMMANDS_PER_STEP);
+    CommandDrainStats stats;
+    uint64_t tick = 0;                           // Keeps counting across repeats: the wheels release in order.
+
+    Result bestPush{1e300, 0.0};
+    Result bestDrain{1e300, 0.0};
+    for (int repeat = 0; repeat < REPEATS; ++repeat) {
+        std::chrono::steady_clock::duration pushTime{};
+        std::chrono::steady_clock::duration drainTime{};
+        size_t pushed = 0;
+        cacheMisses.start();
+        for (uint64_t i = 0; i < iterations; ++i, ++tick) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t j = 0; j < broadcasts; ++j) {
+                const uint64_t target = j % 4 == 0 ? tick + 2 : 0;
+                pushed += queue.tryPush(Command{CommandType::Accelerate, 0.1, target});
+            }
+            for (size_t j = 0; j < COMMAND_PARTITIONS * targetedPerPartition; ++j) {
+                const uint64_t target = j % 4 == 0 ? tick + 2 : 0;
+                const uint32_t entity = static_cast<uint32_t>((j % COMMAND_PARTITIONS) * partitionSpan + j);
+                pushed += router.enqueue(Command{CommandType::Accelerate, 0.1, target, entity});
+            }
+            auto enqueued = std::chrono::steady_clock::now();
+            const StepCommands step = drainCommands(tick, queue, scheduler, router, batch.data(), released.data(),
+                                                    stats, nullptr);
+            auto end = std::chrono::steady_clock::now();
+            if (step.broadcastCount + step.targetedCount == 0) std::abort(); // Keeps the drain observable; never true here.
+            pushTime += enqueued - start;
+            drainTime += end - enqueued;
+        }
+        const uint64_t misses = cacheMisses.stop();
+        const double items = static_cast<double>(pushed);
+        const double missesPerItem = static_cast<double>(misses) / items; // Not split by phase; both are tiny.
+        const double pushNs = std::chrono::duration<double, std::nano>(pushTime).count() / items;
+        const double drainNs = std::chrono::duration<double, std::nano>(drainTime).count() / items;
+        if (pushNs < bestPush.nsPerItem) bestPush = Result{pushNs, missesPerItem};
+        if (drainNs < bestDrain.nsPerItem) bestDrain = Result{drainNs, missesPerItem};
+    }
+    if (selected(filter, "enqueueCommand")) report("enqueueCommand", burst, bestPush);
+    if (selected(filter, "drainCommands")) report("drainCommands", burst, bestDrain);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* filter = nullptr;
+    size_t maxEntities = MAX_ENTITIES;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--max") == 0 && i + 1 < argc) {
+            maxEntities = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (argv[i][0] != '-') {
+            filter = argv[i];
+        } else {
+            std::fprintf(stderr, "usage: %s [FILTER] [--max ENTITIES]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("integrator: %s  cache-miss counter: %s\n", integratorName(activeIntegrator()),
+                cacheMisses.available() ? "on" : "unavailable");
+    std::printf("%-18s %10s %10s %12s %10s\n", "benchmark", "items", "ns/item", "Mitems/s", "miss/item");
+    for (size_t count = 1; count <= maxEntities; count *= 10) benchEntities(filter, count);
+    benchQueue(filter);
+    return 0;
+}
@@ -0,0 +1,29 @@
+TEMPLATE = app
+TARGET = benchmarks
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += thread
+
+# Same code generation as the engine, so the numbers describe what ships.
+!msvc: QMAKE_CXXFLAGS += -ffp-contract=off
+fixed_point: DEFINES += SIM_FIXED_POINT
+
+SOURCES += \
+    bench_main.cpp \
+    ../clock.cpp \
+    ../command_pipeline.cpp \
+    ../integrator.cpp \
+    ../job_system.cpp \
+    ../simulation.cpp \
+    ../state_hash.cpp \
+    ../trace.cpp
+
+HEADERS += \
+    ../clock.h \
+    ../command_pipeline.h \
+    ../command_queue.h \
+    ../engine.h \
+    ../integrator.h \
+    ../numeric.h \
+    ../simulation.h
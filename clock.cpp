@@ -0,0 +1,79 @@
+#include "clock.h"
+
+#include <chrono>
+#include <ctime>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define SIM_HAS_TSC 1                            // 64-bit only: the scaling uses unsigned __int128.
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+const int64_t NANOS_PER_SECOND = 1000000000;
+
+int64_t monotonicNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * NANOS_PER_SECOND + now.tv_nsec;
+}
+
+#ifdef SIM_HAS_TSC
+void sampleTogether(uint64_t& ticks, int64_t& ns) { // Bracket the clock read with two TSC reads; use the midpoint.
+    uint64_t before = __rdtsc();
+    ns = monotonicNs();
+    uint64_t after = __rdtsc();
+    ticks = before + (after - before) / 2;
+}
+#endif
+
+} // namespace
+
+int64_t SteadyClock::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool TscClock::supported() {
+#ifdef SIM_HAS_TSC
+    unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+    if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return false;
+    return (edx & (1u << 8)) != 0;               // CPUID.80000007H:EDX[8] = invariant TSC.
+#else
+    return false;
+#endif
+}
+
+bool TscClock::calibrate(int64_t windowNs) {
+#ifdef SIM_HAS_TSC
+    if (!supported()) return false;
+    uint64_t startTicks = 0, endTicks = 0;
+    int64_t startNs = 0, endNs = 0;
+    sampleTogether(startTicks, startNs);
+    timespec window{static_cast<time_t>(windowNs / NANOS_PER_SECOND), static_cast<long>(windowNs % NANOS_PER_SECOND)};
+    nanosleep(&window, nullptr);                 // Longer window = smaller relative error; 20 ms gives ~1e-6.
+    sampleTogether(endTicks, endNs);
+    if (endTicks <= startTicks || endNs <= startNs) return false;
+
+    const uint64_t elapsedTicks = endTicks - startTicks;
+    const uint64_t elapsedNs = static_cast<uint64_t>(endNs - startNs);
+    nsPerTickQ32_ = static_cast<uint64_t>((static_cast<unsigned __int128>(elapsedNs) << 32) / elapsedTicks);
+    ticksPerNs_ = static_cast<double>(elapsedTicks) / static_cast<double>(elapsedNs);
+    baseTicks_ = endTicks;                       // Anchor to CLOCK_MONOTONIC so readings line up with the pacer's clock.
+    baseNs_ = endNs;
+    return true;
+#else
+    (void)windowNs;
+    return false;
+#endif
+}
+
+int64_t TscClock::nowNs() {
+#ifdef SIM_HAS_TSC
+    const uint64_t elapsed = __rdtsc() - baseTicks_;
+    return baseNs_ + static_cast<int64_t>((static_cast<unsigned __int128>(elapsed) * nsPerTickQ32_) >> 32);
+#else
+    return monotonicNs();
+#endif
+}
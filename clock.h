@@ -0,0 +1,58 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+// Time sources for the frame loop. Everything that measures time (the accumulator, telemetry stamps,
+// instrumentation) reads one Clock in signed 64-bit nanoseconds: +/-292 years of range, no unit
+// conversions until the very edge where seconds feed the physics.
+//
+// Backends:
+//   SteadyClock  - std::chrono::steady_clock at full resolution. Portable default.
+//   TscClock     - rdtsc scaled to ns; ~20x cheaper than a vDSO clock_gettime. Only on CPUs with an
+//                  invariant TSC (constant rate across P/C-states, synchronized across cores).
+//                  Calibrated once against CLOCK_MONOTONIC at startup.
+//   VirtualClock - advances only when told to. Makes the real-time pipeline reproducible for tests.
+// Only differences between two readings of the same clock are meaningful.
+
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual int64_t nowNs() = 0;                 // Monotonic; never goes backwards.
+    virtual const char* name() const = 0;
+};
+
+class SteadyClock final : public Clock {
+public:
+    int64_t nowNs() override;
+    const char* name() const override { return "steady"; }
+};
+
+class TscClock final : public Clock {
+public:
+    static bool supported();                     // x86 with CPUID invariant-TSC bit set.
+    bool calibrate(int64_t windowNs = 20000000); // Measures TSC rate over windowNs of CLOCK_MONOTONIC. False if unsupported.
+
+    int64_t nowNs() override;
+    const char* name() const override { return "tsc"; }
+    double ticksPerNs() const { return ticksPerNs_; }
+
+private:
+    uint64_t baseTicks_ = 0;                     // TSC and CLOCK_MONOTONIC sampled together at calibration.
+    int64_t baseNs_ = 0;
+    uint64_t nsPerTickQ32_ = 0;                  // ns per tick in 32.32 fixed point: a multiply and shift per read.
+    double ticksPerNs_ = 0.0;
+};
+
+class VirtualClock final : public Clock {
+public:
+    int64_t nowNs() override { return nowNs_; }
+    const char* name() const override { return "virtual"; }
+
+    void advance(int64_t ns) { nowNs_ += ns; }
+
+private:
+    int64_t nowNs_ = 0;
+};
+
+#endif // CLOCK_H
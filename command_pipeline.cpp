@@ -0,0 +1,188 @@
+#include "command_pipeline.h"
+
+#include "job_system.h"
+
+void CommandCoalescer::add(const Command& command) {
+    if (command.type == CommandType::Stop) {     // Supersedes everything so far.
+        stopped_ = true;
+        accelerated_ = false;
+        sum_ = 0.0;
+        return;
+    }
+    sum_ = accelerated_ ? sum_ + command.value : command.value; // Left to right, first term taken verbatim.
+    accelerated_ = true;
+}
+
+size_t CommandCoalescer::finish(Command* out) {
+    size_t produced = 0;
+    if (stopped_) out[produced++] = Command{CommandType::Stop, 0.0};
+    if (accelerated_) out[produced++] = Command{CommandType::Accelerate, sum_};
+    *this = CommandCoalescer();
+    return produced;
+}
+
+CommandScheduler::CommandScheduler(size_t capacity) : nodes_(capacity), freeHead_(capacity > 0 ? 0 : NIL) {
+    for (size_t i = 0; i < capacity; ++i) {
+        nodes_[i].next = i + 1 < capacity ? static_cast<uint32_t>(i + 1) : NIL;
+    }
+    for (size_t slot = 0; slot < TIMING_WHEEL_SLOTS; ++slot) {
+        slotHead_[slot] = NIL;
+        slotTail_[slot] = NIL;
+    }
+}
+
+bool CommandScheduler::schedule(const Command& command, uint64_t currentTick) {
+    if (command.targetTick <= currentTick) return false;
+    return insert(command, currentTick);
+}
+
+bool CommandScheduler::restore(const Command& command, uint64_t currentTick) {
+    if (command.targetTick < currentTick) return false; // copyPending() never saves one: the slot was released.
+    return insert(command, currentTick);
+}
+
+bool CommandScheduler::insert(const Command& command, uint64_t currentTick) {
+    if (command.targetTick - currentTick >= TIMING_WHEEL_SLOTS) return false; // Would wrap onto an earlier tick's slot.
+    if (freeHead_ == NIL) return false;
+
+    const uint32_t index = freeHead_;
+    freeHead_ = nodes_[index].next;
+    nodes_[index].command = command;
+    nodes_[index].next = NIL;
+
+    const size_t slot = command.targetTick % TIMING_WHEEL_SLOTS;
+    if (slotTail_[slot] == NIL) slotHead_[slot] = index;
+    else nodes_[slotTail_[slot]].next = index;   // Append: FIFO within a tick.
+    slotTail_[slot] = index;
+    ++pending_;
+    return true;
+}
+
+size_t CommandScheduler::release(uint64_t tick, Command* out) {
+    const size_t slot = tick % TIMING_WHEEL_SLOTS;
+    size_t released = 0;
+    uint32_t index = slotHead_[slot];
+    while (index != NIL) {                       // Horizon check guarantees every node here targets this tick.
+        const uint32_t next = nodes_[index].next;
+        out[released++] = nodes_[index].command;
+        nodes_[index].next = freeHead_;
+        freeHead_ = index;
+        --pending_;
+        index = next;
+    }
+    slotHead_[slot] = NIL;
+    slotTail_[slot] = NIL;
+    return released;
+}
+
+size_t CommandScheduler::copyPending(uint64_t fromTick, Command* out, size_t max) const {
+    size_t copied = 0;
+    for (size_t offset = 0; offset < TIMING_WHEEL_SLOTS && copied < pending_; ++offset) {
+        for (uint32_t index = slotHead_[(fromTick + offset) % TIMING_WHEEL_SLOTS]; index != NIL && copied < max;
+             index = nodes_[index].next) {
+            out[copied++] = nodes_[index].command;
+        }
+    }
+    return copied;
+}
+
+void CommandRouter::configure(size_t entityCount) {
+    entityCount_ = entityCount;
+    const size_t blocks = (entityCount + ENTITY_BLOCK_SIZE - 1) / ENTITY_BLOCK_SIZE;
+    const size_t blocksPerPartition = blocks > COMMAND_PARTITIONS ? (blocks + COMMAND_PARTITIONS - 1) / COMMAND_PARTITIONS : 1;
+    partitionEntities_ = blocksPerPartition * ENTITY_BLOCK_SIZE; // Block-aligned: a block never spans two partitions.
+    partitionCount_ = (entityCount + partitionEntities_ - 1) / partitionEntities_;
+}
+
+bool CommandRouter::enqueue(const Command& command) {
+    if (command.entity >= entityCount_) return false;
+    return partitions_[command.entity / partitionEntities_].queue.tryPush(command);
+}
+
+bool CommandRouter::restore(const Command& command, uint64_t currentTick) {
+    if (command.entity >= entityCount_) return false;
+    return partitions_[command.entity / partitionEntities_].scheduler.restore(command, currentTick);
+}
+
+size_t CommandRouter::drain(uint64_t tick, Command* out, JobSystem* jobs) {
+    drainTick_ = tick;
+    drainOut_ = out;
+    if (jobs) jobs->parallelFor(partitionCount_, 1, &CommandRouter::drainPartitions, this);
+    else drainPartitions(this, 0, partitionCount_);
+
+    size_t count = 0;                            // Partitions wrote to fixed regions of out; close the gaps in order.
+    for (size_t p = 0; p < partitionCount_; ++p) {
+        const Command* region = out + p * PARTITION_MAX_RELEASED;
+        for (size_t i = 0; i < partitions_[p].appliedCount; ++i) out[count++] = region[i];
+    }
+    return count;
+}
+
+void CommandRouter::drainPartitions(void* context, size_t first, size_t last) {
+    CommandRouter& router = *static_cast<CommandRouter*>(context);
+    for (size_t p = first; p < last; ++p) router.drainPartition(p);
+}
+
+void CommandRouter::drainPartition(size_t partition) {
+    Partition& part = partitions_[partition];
+    const uint64_t tick = drainTick_;
+    Command* released = part.released;
+
+    size_t count = part.scheduler.release(tick, released); // Scheduled earlier for this tick: they arrived first.
+    Command drained[PARTITION_QUEUE_CAPACITY];
+    const size_t drainedCount = part.queue.popBatch(drained, PARTITION_QUEUE_CAPACITY);
+    part.drained += drainedCount;
+    for (size_t i = 0; i < drainedCount; ++i) {
+        if (drained[i].targetTick <= tick) released[count++] = drained[i]; // Due now or late: this step.
+        else if (!part.scheduler.schedule(drained[i], tick)) ++part.rejected;
+    }
+
+    for (size_t i = 1; i < count; ++i) {         // Stable insertion sort by entity: FIFO kept per entity, no allocation.
+        const Command command = released[i];
+        size_t j = i;
+        for (; j > 0 && released[j - 1].entity > command.entity; --j) released[j] = released[j - 1];
+        released[j] = command;
+    }
+
+    Command* out = drainOut_ + partition * PARTITION_MAX_RELEASED;
+    size_t applied = 0;
+    for (size_t begin = 0; begin < count;) {     // One coalescer run per entity.
+        const uint32_t entity = released[begin].entity;
+        CommandCoalescer coalescer;
+        size_t end = begin;
+        for (; end < count && released[end].entity == entity; ++end) coalescer.add(released[end]);
+        const size_t produced = coalescer.finish(out + applied);
+        for (size_t i = 0; i < produced; ++i) out[applied + i].entity = entity;
+        applied += produced;
+        begin = end;
+    }
+    part.appliedCount = applied;
+}
+
+uint64_t CommandRouter::drained() const {
+    uint64_t total = 0;
+    for (size_t p = 0; p < partitionCount_; ++p) total += partitions_[p].drained;
+    return total;
+}
+
+uint64_t CommandRouter::rejected() const {
+    uint64_t total = 0;
+    for (size_t p = 0; p < partitionCount_; ++p) total += partitions_[p].rejected;
+    return total;
+}
+
+StepCommands drainCommands(uint64_t tick, CommandQueue& queue, CommandScheduler& scheduler, CommandRouter& router,
+                           Command* out, Command* released, CommandDrainStats& stats, JobSystem* jobs) {
+    const size_t scheduled = scheduler.release(tick, released); // Scheduled earlier for this tick: they arrived first.
+    const size_t raw = queue.popBatch(released + scheduled, MAX_COMMANDS_DRAINED_PER_STEP); // Empty the queue.
+    stats.drained += raw;
+    CommandCoalescer coalescer;
+    for (size_t i = 0; i < scheduled; ++i) coalescer.add(released[i]);
+    for (size_t i = scheduled; i < scheduled + raw; ++i) {
+        if (released[i].targetTick <= tick) coalescer.add(released[i]); // Due now or late: this step.
+        else if (!scheduler.schedule(released[i], tick)) ++stats.rejected;
+    }
+    const size_t broadcasts = coalescer.finish(out); // At most Stop + one summed Accelerate.
+    const size_t targeted = router.drain(tick, out + broadcasts, jobs); // Partitions drain in parallel.
+    return StepCommands{out, broadcasts, out + broadcasts, targeted};
+}
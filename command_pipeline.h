@@ -0,0 +1,180 @@
+#ifndef COMMAND_PIPELINE_H
+#define COMMAND_PIPELINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "command_queue.h"
+#include "simulation.h"
+
+class JobSystem;
+
+// Command path between the ingestion queues and applyCommand:
+//   queue drain -> CommandScheduler (hold until Command::targetTick) -> CommandCoalescer -> apply.
+// Broadcast commands (entity == ALL_ENTITIES) take this path through one queue on the sim thread.
+// Entity-targeted commands take it per partition through CommandRouter (below).
+//
+// Scheduling: a command is applied at the step whose sim.tick equals its targetTick, independent of
+// when it was enqueued or drained. Commands due now or already late (targetTick <= tick, including the
+// default 0) are applied at the next step. Commands more than TIMING_WHEEL_SLOTS ticks ahead, or
+// arriving while the node pool is full, are rejected and counted. Within a step, commands keep their
+// arrival order: earlier-scheduled ones first, then the ones drained this step.
+//
+// Coalescing rule (applied per target to the commands released for one step, in that order):
+//   1. A Stop supersedes every command before it: the earlier ones are dropped.
+//   2. The remaining Accelerates (after the last Stop) become one Accelerate whose value is their
+//      left-to-right sum: ((a1 + a2) + a3) + ...
+//   Output: [Stop]? [Accelerate sum]?  - at most COALESCED_COMMANDS_MAX commands, in that order.
+//
+// Rule 1 is exact: within a step nothing changes validity between commands, and Stop overwrites the
+// velocity any earlier Accelerate produced. Rule 2 is not bit-identical to applying the Accelerates
+// one by one (v + a1 + a2 rounds differently from v + (a1 + a2)), but it is a pure function of the
+// released sequence, so every run that releases the same sequence gets the same result. The journal
+// records the coalesced commands that were actually applied, so replays reproduce the run exactly.
+// Coalescing an already coalesced batch returns it unchanged.
+
+const size_t COALESCED_COMMANDS_MAX = 2;         // Stop + Accelerate.
+const size_t MAX_COMMANDS_DRAINED_PER_STEP = MAX_COMMAND_QUEUE_SIZE; // Drain everything queued; coalescing bounds the cost.
+const size_t TIMING_WHEEL_SLOTS = 1024;          // Scheduling horizon in ticks: 10.24 s at FIXED_DT_SECONDS.
+const size_t MAX_SCHEDULED_COMMANDS = 4096;      // Preallocated wheel nodes: broadcast commands waiting for a future tick.
+
+const size_t COMMAND_PARTITIONS = 16;            // Entity ranges with their own queue, scheduler and coalescer.
+const size_t PARTITION_QUEUE_CAPACITY = 32;
+const size_t PARTITION_SCHEDULED_COMMANDS = 256; // Wheel nodes per partition.
+const size_t PARTITION_MAX_RELEASED = PARTITION_QUEUE_CAPACITY + PARTITION_SCHEDULED_COMMANDS; // Per partition per step.
+const size_t MAX_TARGETED_COMMANDS_PER_STEP = COMMAND_PARTITIONS * PARTITION_MAX_RELEASED; // Coalescing never adds commands.
+
+using PartitionQueue = MpscRingBuffer<Command, PARTITION_QUEUE_CAPACITY>;
+
+static_assert(COALESCED_COMMANDS_MAX <= static_cast<size_t>(MAX_COMMANDS_PER_STEP),
+              "a coalesced batch must fit the per-step command budget");
+
+class CommandCoalescer {                         // Streaming form of the rule above; O(1) state.
+public:
+    void add(const Command& command);
+    size_t finish(Command* out);                 // Writes up to COALESCED_COMMANDS_MAX commands, then resets.
+
+private:
+    bool stopped_ = false;
+    bool accelerated_ = false;
+    double sum_ = 0.0;
+};
+
+// Timing wheel with one slot per tick of the horizon. Each slot is a FIFO list threaded through a
+// node pool allocated at construction, so schedule() and the per-tick release are O(1) plus
+// O(commands released), and nothing allocates afterwards. release() must be called for every tick, in order.
+class CommandScheduler {
+public:
+    explicit CommandScheduler(size_t capacity = MAX_SCHEDULED_COMMANDS);
+
+    // Holds command until its targetTick. currentTick = the next step to run. False = rejected
+    // (beyond the horizon or pool full). Commands due at or before currentTick are not accepted here;
+    // the caller applies them directly (see drain order above).
+    bool schedule(const Command& command, uint64_t currentTick);
+    // Restore only: as schedule(), but also takes commands due at currentTick. A snapshot saves those
+    // from the slot the next step releases, and they must go back there, ahead of anything drained.
+    bool restore(const Command& command, uint64_t currentTick);
+
+    size_t release(uint64_t tick, Command* out); // Copies tick's commands in FIFO order (room for capacity()) and frees them.
+
+    size_t capacity() const { return nodes_.size(); }
+    size_t pending() const { return pending_; }
+    // Copies up to max waiting commands in release order (tick by tick from fromTick, FIFO within a tick).
+    size_t copyPending(uint64_t fromTick, Command* out, size_t max) const;
+
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Node {
+        Command command;
+        uint32_t next;
+    };
+
+    bool insert(const Command& command, uint64_t currentTick); // Horizon and pool checks, then append to the slot.
+
+    std::vector<Node> nodes_;
+    uint32_t freeHead_;
+    uint32_t slotHead_[TIMING_WHEEL_SLOTS];
+    uint32_t slotTail_[TIMING_WHEEL_SLOTS];
+    size_t pending_ = 0;
+};
+
+// Entity-addressed command routing. Entities are split into COMMAND_PARTITIONS contiguous ranges aligned
+// to ENTITY_BLOCK_SIZE. Each partition has its own MPSC queue, scheduler and coalescing scratch, so
+// producers contend only with producers of the same partition, and drain() processes partitions in
+// parallel with nothing shared between them.
+//
+// Determinism: per entity, commands keep their FIFO order (queue order, then scheduler order as for
+// broadcasts) and are coalesced by the same rule. drain() emits one array sorted by entity, so the
+// apply order does not depend on which worker handled which partition. Different entities never
+// interact within a step, so their relative order does not matter. Against broadcasts there is no
+// order: a step applies all of its broadcasts first. Ordering across the two streams would need one
+// arrival counter shared by every producer, the contention the partitions exist to avoid.
+class CommandRouter {
+public:
+    CommandRouter() = default;
+
+    CommandRouter(const CommandRouter&) = delete;
+    CommandRouter& operator=(const CommandRouter&) = delete;
+
+    void configure(size_t entityCount);          // Before any producer runs; fixes the partition geometry.
+
+    bool enqueue(const Command& command);        // Any thread. False = no such entity, or its partition queue is full.
+    bool restore(const Command& command, uint64_t currentTick); // Sim thread; CommandScheduler::restore for its partition.
+
+    // Releases, drains and coalesces every partition for tick (in parallel on jobs, if given) and writes
+    // the commands to apply to out, sorted by entity. out needs MAX_TARGETED_COMMANDS_PER_STEP. Returns the count.
+    size_t drain(uint64_t tick, Command* out, JobSystem* jobs);
+
+    size_t partitionCount() const { return partitionCount_; }
+    PartitionQueue& queue(size_t partition) { return partitions_[partition].queue; }
+    const CommandScheduler& scheduler(size_t partition) const { return partitions_[partition].scheduler; }
+
+    uint64_t drained() const;                    // Sim thread (between steps): totals over all partitions.
+    uint64_t rejected() const;
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Partition {
+        PartitionQueue queue;
+        CommandScheduler scheduler{PARTITION_SCHEDULED_COMMANDS};
+        Command released[PARTITION_MAX_RELEASED]; // This step's commands, before coalescing.
+        size_t appliedCount = 0;
+        uint64_t drained = 0;
+        uint64_t rejected = 0;
+    };
+
+    static void drainPartitions(void* context, size_t first, size_t last);
+    void drainPartition(size_t partition);
+
+    Partition partitions_[COMMAND_PARTITIONS];
+    size_t entityCount_ = 0;
+    size_t partitionEntities_ = ENTITY_BLOCK_SIZE;
+    size_t partitionCount_ = 0;
+    uint64_t drainTick_ = 0;                     // Arguments of the drain() in progress, for the jobs.
+    Command* drainOut_ = nullptr;
+};
+
+struct StepCommands {                            // What one step applies, as stepSimulation() takes it.
+    const Command* broadcast = nullptr;
+    size_t broadcastCount = 0;
+    const Command* targeted = nullptr;           // Sorted by entity.
+    size_t targetedCount = 0;
+};
+
+struct CommandDrainStats {                       // Broadcast side; the router keeps its own per partition.
+    uint64_t drained = 0;                        // Popped from the queue.
+    uint64_t rejected = 0;                       // targetTick beyond the scheduling horizon, or scheduler full.
+};
+
+const size_t MAX_APPLIED_COMMANDS_PER_STEP = COALESCED_COMMANDS_MAX + MAX_TARGETED_COMMANDS_PER_STEP;
+const size_t MAX_RELEASED_COMMANDS_PER_STEP = MAX_SCHEDULED_COMMANDS + MAX_COMMANDS_DRAINED_PER_STEP;
+
+// The live drain for one step: broadcast scheduler release, the whole queue, coalescing (future commands
+// go to the wheel), then every router partition. out needs MAX_APPLIED_COMMANDS_PER_STEP and receives the
+// coalesced broadcasts followed by the targeted commands; released is scratch for
+// MAX_RELEASED_COMMANDS_PER_STEP. Sim thread only.
+StepCommands drainCommands(uint64_t tick, CommandQueue& queue, CommandScheduler& scheduler, CommandRouter& router,
+                           Command* out, Command* released, CommandDrainStats& stats, JobSystem* jobs);
+
+#endif // COMMAND_PIPELINE_H
@@ -0,0 +1,92 @@
+#ifndef COMMAND_QUEUE_H
+#define COMMAND_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free multi-producer / single-consumer ring buffer.
+// Producers (UI, network, sensor threads) call tryPush() concurrently; only the simulation thread pops.
+// Each slot carries a sequence number (Vyukov scheme): producers claim a slot with one CAS on the tail,
+// write the payload, then publish it by bumping the slot's sequence. The consumer never writes shared
+// indices the producers spin on, so the simulation thread sees no mutex and no contention.
+// Full queue = push fails immediately (drop-on-full overload policy); nothing ever blocks or allocates.
+
+const size_t CACHE_LINE_SIZE = 64;               // x86 and most ARM cores; avoids false sharing between indices.
+
+template <typename T, size_t Capacity>
+class MpscRingBuffer {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    MpscRingBuffer() {
+        for (size_t i = 0; i < Capacity; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed); // Slot i is free for ticket i.
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    bool tryPush(const T& value) {               // Any thread. Returns false if the queue is full (command dropped).
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[pos & MASK];
+            size_t seq = slot.sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {                     // Slot free for this ticket; try to claim it.
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = value;
+                    slot.sequence.store(pos + 1, std::memory_order_release); // Publish to the consumer.
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;                    // Consumer hasn't freed this slot yet: queue is full.
+            } else {
+                pos = tail_.load(std::memory_order_relaxed); // Another producer won the ticket; reload.
+            }
+        }
+    }
+
+    bool tryPop(T& out) {                        // Simulation thread only.
+        return popBatch(&out, 1) == 1;
+    }
+
+    size_t popBatch(T* out, size_t maxCount) {   // Simulation thread only. Drains up to maxCount in FIFO order.
+        size_t pos = head_.load(std::memory_order_relaxed);
+        size_t count = 0;
+        while (count < maxCount) {
+            Slot& slot = slots_[pos & MASK];
+            if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+                break;                           // Empty, or the next producer hasn't finished writing: keep FIFO order.
+            }
+            out[count++] = slot.value;
+            slot.sequence.store(pos + Capacity, std::memory_order_release); // Hand the slot back for the next lap.
+            ++pos;
+        }
+        head_.store(pos, std::memory_order_relaxed);
+        return count;
+    }
+
+    size_t sizeApprox() const {                  // Racy by nature; for monitoring only.
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    static constexpr size_t MASK = Capacity - 1;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0}; // Producers' claim index.
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0}; // Consumer's read index; own line so pops don't bounce producers.
+    alignas(CACHE_LINE_SIZE) Slot slots_[Capacity];
+};
+
+#endif // COMMAND_QUEUE_H
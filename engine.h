@@ -0,0 +1,110 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <cstdint>
+
+#include "simulation.h"
+#include "trace.h"
+
+// The fixed-step core of the frame loop (measure dt, clamp it, run whole ticks off the accumulator) as a
+// policy-based template, so the loop is written once and compiled per configuration.
+//
+//   State          What is evolved. Needs tick, timeAccumulator and stepSeconds members (SimulationState).
+//   Integrator     step(State&, commands): one fixed tick, given what the CommandPolicy drained for it.
+//   CommandPolicy  drain(uint64_t tick): the commands one tick applies, in whatever type Integrator takes.
+//   Clock          nowNs(): monotonic nanoseconds. A concrete clock type inlines the call; the Clock
+//                  interface (clock.h) keeps the choice at runtime.
+//   Config         Tick length and caps as static constexpr members; see DefaultEngineConfig.
+//
+// Policies are held by reference and nothing is virtual. Tick length and caps are compile-time
+// constants, so the step loop has a constant bound and no loads of tuning globals. Engines with different
+// Configs can live in one binary. Each one sets its State's stepSeconds, and the step reads that value.
+// Presentation, pacing and input stay with the caller: an engine only turns elapsed time into ticks.
+
+struct DefaultEngineConfig {                     // The tuning main() runs with (constants in simulation.h).
+    static constexpr double FIXED_DT_SECONDS = ::FIXED_DT_SECONDS;
+    static constexpr double MAX_DT_SECONDS = ::MAX_DT_SECONDS;
+    static constexpr int MAX_STEPS_PER_FRAME = MAX_SIMULATION_STEPS_PER_FRAME;
+};
+
+struct EngineFrame {                             // What one advanceFrame() did; timestamps for the caller's layer stats.
+    int64_t nowNs;                               // Frame timestamp, sampled once at the top.
+    int64_t dtNs;                                // Measured (unclamped) delta since the previous frame.
+    int64_t measuredNs;                          // End of the measurement layer.
+    int64_t clampedNs;                           // End of the clamp layer; the ticks ran after this.
+    int steps;                                   // Fixed ticks run this frame.
+    bool overloaded;                             // Hit MAX_STEPS_PER_FRAME: the accumulator was discarded.
+};
+
+template <typename State, typename Integrator, typename CommandPolicy, typename Clock, typename Config>
+class SimulationEngine {
+    static_assert(Config::FIXED_DT_SECONDS > 0.0, "tick length must be positive");
+    static_assert(Config::FIXED_DT_SECONDS < REAL_MAX_STEP_SECONDS, "tick length must fit the Q32.32 scaleReal factor");
+    static_assert(Config::MAX_DT_SECONDS >= Config::FIXED_DT_SECONDS, "the dt clamp must allow at least one tick per frame");
+    static_assert(Config::MAX_STEPS_PER_FRAME >= 1, "a frame must be able to run a tick");
+
+public:
+    static constexpr int64_t NANOS_PER_SECOND = 1000000000;
+    static constexpr int64_t FIXED_DT_NS = static_cast<int64_t>(Config::FIXED_DT_SECONDS * NANOS_PER_SECOND + 0.5);
+
+    SimulationEngine(State& state, Integrator& integrator, CommandPolicy& commands, Clock& clock)
+        : state_(state), integrator_(integrator), commands_(commands), clock_(clock) {
+        state_.stepSeconds = Config::FIXED_DT_SECONDS;
+    }
+
+    SimulationEngine(const SimulationEngine&) = delete;
+    SimulationEngine& operator=(const SimulationEngine&) = delete;
+
+    void start() { lastNs_ = clock_.nowNs(); }   // Anchor dt measurement; call right before the first frame.
+
+    void step() {                                // Drain, step: one fixed tick, identical in every run mode.
+        TRACE_SCOPE("step");
+        integrator_.step(state_, commands_.drain(state_.tick));
+    }
+
+    EngineFrame advanceFrame() {                 // One frame's worth of fixed ticks, by wall-clock time.
+        EngineFrame frame{};
+
+        // --- LAYER 1: TEMPORAL MEASUREMENTS (INPUT LAYER) ---
+        frame.nowNs = clock_.nowNs();            // Sample time once per loop.
+        frame.dtNs = frame.nowNs - lastNs_;      // Elapsed time since last loop; drives physics and scheduling.
+        lastNs_ = frame.nowNs;                   // Update temporal anchor to prevent dt accumulation errors.
+        double dtSeconds = static_cast<double>(frame.dtNs) / NANOS_PER_SECOND; // Seconds only here, at the physics edge.
+        frame.measuredNs = clock_.nowNs();
+
+        // --- LAYER 2: SECURITY GATE (CLAMPING) ---
+        if (dtSeconds > Config::MAX_DT_SECONDS) { // Protect simulation from exploding if real time jumps.
+            dtSeconds = Config::MAX_DT_SECONDS;  // This is the clamp; throw away excess real time.
+        }
+        state_.timeAccumulator += dtSeconds;     // Track total usable time (Measurement != Simulation).
+        frame.clampedNs = clock_.nowNs();
+
+        // --- LAYER 3: DETERMINISTIC ENGINE (SIMULATION LAYER) ---
+        while (state_.timeAccumulator >= Config::FIXED_DT_SECONDS && frame.steps < Config::MAX_STEPS_PER_FRAME) {
+            step();
+            state_.timeAccumulator -= Config::FIXED_DT_SECONDS; // Spend the simulated time.
+            frame.steps++;
+        }
+
+        if (frame.steps == Config::MAX_STEPS_PER_FRAME) {
+            state_.timeAccumulator = 0.0;        // If overloaded, discard excess time to prevent spiral-of-death.
+            frame.overloaded = true;
+        }
+        return frame;
+    }
+
+    double alpha() const {                       // Fractional progress between the last two ticks, for interpolation.
+        return state_.timeAccumulator / Config::FIXED_DT_SECONDS;
+    }
+
+    State& state() { return state_; }
+
+private:
+    State& state_;
+    Integrator& integrator_;
+    CommandPolicy& commands_;
+    Clock& clock_;
+    int64_t lastNs_ = 0;
+};
+
+#endif // ENGINE_H
@@ -0,0 +1,86 @@
+#include "frame_pacer.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIM_CPU_RELAX() _mm_pause()              // Tells the core we're spinning: saves power, frees the sibling hyperthread.
+#else
+#define SIM_CPU_RELAX() ((void)0)
+#endif
+
+namespace {
+
+const int64_t NANOS_PER_SECOND = 1000000000;
+
+int64_t monotonicNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);        // Same clock steady_clock uses on Linux, and the one clock_nanosleep sleeps on.
+    return static_cast<int64_t>(now.tv_sec) * NANOS_PER_SECOND + now.tv_nsec;
+}
+
+void sleepUntil(int64_t deadlineNs) {
+    timespec target;
+    target.tv_sec = static_cast<time_t>(deadlineNs / NANOS_PER_SECOND);
+    target.tv_nsec = static_cast<long>(deadlineNs % NANOS_PER_SECOND);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+        // Absolute deadline: resuming after a signal needs no correction.
+    }
+}
+
+} // namespace
+
+FramePacer::FramePacer(double framesPerSecond, int64_t spinNs)
+    : periodNs_(static_cast<int64_t>(NANOS_PER_SECOND / framesPerSecond)),
+      spinNs_(spinNs) {
+    assert(periodNs_ > 0 && periodNs_ >= spinNs_ && "frame rate out of range: the period must cover the spin margin");
+}
+
+void FramePacer::start() {
+    deadlineNs_ = monotonicNs() + periodNs_;
+}
+
+void FramePacer::waitForNextFrame() {
+    int64_t now = monotonicNs();
+    if (now >= deadlineNs_) {                    // Overrun: work took the whole period. Don't wait, don't burst.
+        ++overruns_;
+        record(now - deadlineNs_);
+        int64_t missed = (now - deadlineNs_) / periodNs_ + 1;
+        deadlineNs_ += missed * periodNs_;       // Next boundary in the future, same phase.
+        return;
+    }
+
+    if (deadlineNs_ - now > spinNs_) {
+        sleepUntil(deadlineNs_ - spinNs_);       // Coarse phase: give the CPU away.
+    }
+    do {                                         // Fine phase: spin out timer slack.
+        SIM_CPU_RELAX();
+        now = monotonicNs();
+    } while (now < deadlineNs_);
+
+    record(now - deadlineNs_);
+    deadlineNs_ += periodNs_;
+}
+
+void FramePacer::record(int64_t lateNs) {
+    ++frames_;
+    if (frames_ == 1 || lateNs < minLateNs_) minLateNs_ = lateNs;
+    if (frames_ == 1 || lateNs > maxLateNs_) maxLateNs_ = lateNs;
+    double delta = static_cast<double>(lateNs) - mean_;
+    mean_ += delta / static_cast<double>(frames_);
+    m2_ += delta * (static_cast<double>(lateNs) - mean_);
+}
+
+PacerStats FramePacer::stats() const {
+    PacerStats out;
+    out.frames = frames_;
+    out.overruns = overruns_;
+    out.minLateNs = minLateNs_;
+    out.maxLateNs = maxLateNs_;
+    out.meanLateNs = mean_;
+    out.stddevLateNs = frames_ > 1 ? std::sqrt(m2_ / static_cast<double>(frames_ - 1)) : 0.0;
+    return out;
+}
@@ -0,0 +1,55 @@
+#ifndef FRAME_PACER_H
+#define FRAME_PACER_H
+
+#include <cstdint>
+
+// Deadline-based frame pacing. Frames are anchored to absolute boundaries start + k * period, so the
+// time a frame spends working is absorbed instead of added on top (sleep_for(16ms) after 3 ms of work
+// is a 19 ms frame). Waiting happens in two phases:
+//   1. clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME) until deadline - spin margin. Absolute, so an
+//      interrupted or late wake never accumulates drift; the margin absorbs kernel timer slack.
+//   2. Busy-wait on the clock for the last stretch; costs at most spinNs of CPU per frame.
+// A frame that overruns its boundary skips to the next future boundary (keeps phase, no catch-up burst).
+//
+// Jitter is recorded as lateness = actual wake time - deadline, per frame.
+
+struct PacerStats {
+    uint64_t frames = 0;
+    uint64_t overruns = 0;                       // Frames that finished their work after the deadline.
+    int64_t minLateNs = 0;
+    int64_t maxLateNs = 0;
+    double meanLateNs = 0.0;
+    double stddevLateNs = 0.0;
+};
+
+const int64_t DEFAULT_SPIN_NS = 200000;          // Busy-wait margin before each boundary.
+// Fastest useful rate: a period no longer than the spin margin never sleeps, so the pacer would only
+// burn a core busy-waiting. 5000 fps (200 us) with the default margin.
+constexpr double MAX_FRAMES_PER_SECOND = 1e9 / DEFAULT_SPIN_NS;
+
+class FramePacer {
+public:
+    explicit FramePacer(double framesPerSecond, int64_t spinNs = DEFAULT_SPIN_NS); // Period must exceed spinNs.
+
+    void start();                                // Anchor the first boundary one period from now.
+    void waitForNextFrame();                     // Returns at (or just after) the next boundary.
+
+    int64_t periodNs() const { return periodNs_; }
+    PacerStats stats() const;
+
+private:
+    void record(int64_t lateNs);
+
+    int64_t periodNs_;
+    int64_t spinNs_;
+    int64_t deadlineNs_ = 0;
+
+    uint64_t frames_ = 0;                        // Welford running statistics; no per-frame storage.
+    uint64_t overruns_ = 0;
+    int64_t minLateNs_ = 0;
+    int64_t maxLateNs_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+};
+
+#endif // FRAME_PACER_H
@@ -0,0 +1,73 @@
+#include "frame_stats.h"
+
+namespace {
+
+const uint64_t LINEAR_LIMIT = 2 * LatencyHistogram::SUB_BUCKET_COUNT; // Below this, one bucket per ns.
+const uint64_t MAX_TRACKED_VALUE =
+    (uint64_t(1) << (LatencyHistogram::MAX_EXPONENT + LatencyHistogram::SUB_BUCKET_BITS)) - 1;
+
+const char* const LAYER_NAMES[FRAME_LAYER_COUNT] = {"measure", "clamp", "engine", "present"};
+
+} // namespace
+
+size_t LatencyHistogram::bucketFor(uint64_t value) {
+    if (value < LINEAR_LIMIT) return static_cast<size_t>(value);
+    if (value > MAX_TRACKED_VALUE) value = MAX_TRACKED_VALUE;
+    const unsigned msb = 63u - static_cast<unsigned>(__builtin_clzll(value));
+    const unsigned exponent = msb - SUB_BUCKET_BITS; // >= 1 here.
+    const uint64_t mantissa = value >> exponent;     // In [SUB_BUCKET_COUNT, 2 * SUB_BUCKET_COUNT).
+    return static_cast<size_t>(LINEAR_LIMIT + (exponent - 1) * SUB_BUCKET_COUNT + (mantissa - SUB_BUCKET_COUNT));
+}
+
+uint64_t LatencyHistogram::bucketUpperEdge(size_t bucket) {
+    if (bucket < LINEAR_LIMIT) return bucket;
+    const uint64_t offset = bucket - LINEAR_LIMIT;
+    const unsigned exponent = static_cast<unsigned>(offset / SUB_BUCKET_COUNT) + 1;
+    const uint64_t mantissa = offset % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+    return ((mantissa + 1) << exponent) - 1;
+}
+
+void LatencyHistogram::record(int64_t valueNs) {
+    const uint64_t value = valueNs > 0 ? static_cast<uint64_t>(valueNs) : 0;
+    counts_[bucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+    if (valueNs > max_.load(std::memory_order_relaxed)) {
+        max_.store(valueNs, std::memory_order_relaxed); // Single writer: no CAS loop needed.
+    }
+}
+
+uint64_t LatencyHistogram::count() const {
+    uint64_t total = 0;
+    for (const std::atomic<uint64_t>& bucket : counts_) total += bucket.load(std::memory_order_relaxed);
+    return total;
+}
+
+int64_t LatencyHistogram::percentile(double fraction) const {
+    const uint64_t total = count();
+    if (total == 0) return 0;
+    if (fraction < 0.0) fraction = 0.0;
+    if (fraction > 1.0) fraction = 1.0;
+    uint64_t rank = static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5);
+    if (rank == 0) rank = 1;                     // p0 = the smallest recorded value's bucket.
+
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; ++bucket) {
+        seen += counts_[bucket].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            const int64_t edge = static_cast<int64_t>(bucketUpperEdge(bucket));
+            return edge < max() ? edge : max();
+        }
+    }
+    return max();                                // Counts moved under us; the max is still an upper bound.
+}
+
+void FrameStats::report(std::ostream& out) const {
+    for (size_t i = 0; i < FRAME_LAYER_COUNT; ++i) {
+        const LatencyHistogram& histogram = layers_[i];
+        out << "layer " << LAYER_NAMES[i] << " n=" << histogram.count()
+            << " p50=" << histogram.percentile(0.50) / 1000.0
+            << "us p99=" << histogram.percentile(0.99) / 1000.0
+            << "us p99.9=" << histogram.percentile(0.999) / 1000.0
+            << "us max=" << histogram.max() / 1000.0 << "us" << '\n';
+    }
+    out << "overload discards=" << overloadDiscards() << '\n';
+}
@@ -0,0 +1,65 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Tail-latency instrumentation for the frame loop.
+//
+// LatencyHistogram is log-linear (HDR-style): values below 64 ns get exact buckets, and above that
+// every power of two is split into 32 linear sub-buckets. Each bucket is within ~3% of the true
+// value from 1 ns up to ~73 minutes, in a fixed 1216-bucket array (~10 KB, no allocation).
+// record() is a handful of integer ops plus one relaxed atomic increment. A monitoring thread can
+// read percentiles while the frame loop keeps recording; no locks anywhere.
+// The histogram has one writer (the frame loop). Readers may see a snapshot that is a few records
+// stale, never a torn count.
+
+class LatencyHistogram {
+public:
+    static const unsigned SUB_BUCKET_BITS = 5;
+    static const uint64_t SUB_BUCKET_COUNT = 1u << SUB_BUCKET_BITS;
+    static const unsigned MAX_EXPONENT = 37;     // Largest bucketed value: 2^42 - 1 ns. Larger values are clamped.
+    static const size_t BUCKET_COUNT = 2 * SUB_BUCKET_COUNT + (MAX_EXPONENT - 1) * SUB_BUCKET_COUNT;
+
+    void record(int64_t valueNs);                // Single writer. Negative values count as 0.
+
+    uint64_t count() const;
+    int64_t max() const { return max_.load(std::memory_order_relaxed); }
+    int64_t percentile(double fraction) const;   // fraction in [0, 1]; upper edge of the bucket, never above max().
+
+private:
+    static size_t bucketFor(uint64_t value);
+    static uint64_t bucketUpperEdge(size_t bucket);
+
+    std::atomic<uint64_t> counts_[BUCKET_COUNT] = {};
+    std::atomic<int64_t> max_{0};
+};
+
+enum class FrameLayer {
+    Measurement,                                 // Layer 1: clock sample and dt.
+    Clamp,                                       // Layer 2: dt clamp and accumulation.
+    Engine,                                      // Layer 3: fixed steps, overload discard, snapshot trigger.
+    Presentation,                                // Layer 4: interpolation into the presentation buffer.
+    Count
+};
+
+const size_t FRAME_LAYER_COUNT = static_cast<size_t>(FrameLayer::Count);
+
+class FrameStats {
+public:
+    void record(FrameLayer layer, int64_t ns) { layers_[static_cast<size_t>(layer)].record(ns); }
+    void recordOverloadDiscard() { overloadDiscards_.fetch_add(1, std::memory_order_relaxed); }
+
+    const LatencyHistogram& layer(FrameLayer layer) const { return layers_[static_cast<size_t>(layer)]; }
+    uint64_t overloadDiscards() const { return overloadDiscards_.load(std::memory_order_relaxed); }
+
+    void report(std::ostream& out) const;        // One line per layer: count, p50, p99, p99.9, max (us).
+
+private:
+    LatencyHistogram layers_[FRAME_LAYER_COUNT];
+    std::atomic<uint64_t> overloadDiscards_{0};  // Frames where stepsThisFrame hit the cap and the accumulator was dropped.
+};
+
+#endif // FRAME_STATS_H
@@ -0,0 +1,77 @@
+#ifndef INTEGRATOR_H
+#define INTEGRATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "state_hash.h"
+
+// Batch kernels behind updateSystem() and interpolateState(). Integration: position += velocity * dt, then clamp-and-invalidate
+// any entity whose position went negative. Three implementations share one contract:
+//   - Scalar: portable reference, runs everywhere.
+//   - AVX2:   4 entities per instruction, branch-free via masked blends.
+//   - AVX-512: 8 entities per instruction, branch-free via mask registers.
+// All of them perform the same IEEE-754 operations in the same order (one multiply, one add, no FMA),
+// so results are bit-identical whichever kernel the CPU ends up running. Determinism does not depend on hardware.
+// With SIM_FIXED_POINT (numeric.h) the same kernels run on Q32.32 integers: velocity * dt is scaleReal()'s
+// two 32x32 multiplies, then an integer add and a signed compare. dt must be in [0, 0.5) there.
+//
+// Kernels read one state (position, velocity, valid) and write the next into out*; in and out may be
+// the same arrays (in place), but must not otherwise overlap. Out-of-place is what the fixed step uses:
+// it reads last tick's buffer and writes the other one, so no copy of the world is needed.
+//
+// Passing a HashAccumulator also accumulates the state hash (state_hash.h) of the integrated entities
+// while they are still in registers. Entity indices for the hash key are hashIndex + (0..count-1): a call
+// covering part of a block passes that part's offset within the block.
+
+enum class IntegratorKind {
+    Scalar, Avx2, Avx512
+};
+
+using IntegrateFn = void (*)(const Real* position, const Real* velocity, const uint8_t* valid,
+                             Real* outPosition, Real* outVelocity, uint8_t* outValid, size_t count,
+                             double dtSeconds, HashAccumulator* hash, uint32_t hashIndex);
+
+void integrateScalar(const Real* position, const Real* velocity, const uint8_t* valid, Real* outPosition,
+                     Real* outVelocity, uint8_t* outValid, size_t count, double dtSeconds,
+                     HashAccumulator* hash = nullptr, uint32_t hashIndex = 0);
+void integrateAvx2(const Real* position, const Real* velocity, const uint8_t* valid, Real* outPosition,
+                   Real* outVelocity, uint8_t* outValid, size_t count, double dtSeconds,
+                   HashAccumulator* hash = nullptr, uint32_t hashIndex = 0);
+void integrateAvx512(const Real* position, const Real* velocity, const uint8_t* valid, Real* outPosition,
+                     Real* outVelocity, uint8_t* outValid, size_t count, double dtSeconds,
+                     HashAccumulator* hash = nullptr, uint32_t hashIndex = 0);
+
+bool integratorSupported(IntegratorKind kind);   // Runtime CPU check; the binary itself targets the baseline ISA.
+IntegratorKind activeIntegrator();               // Best supported kernel, resolved once. SIM_INTEGRATOR=scalar|avx2|avx512 overrides.
+const char* integratorName(IntegratorKind kind);
+
+void integrate(const Real* position, const Real* velocity, const uint8_t* valid, Real* outPosition,
+               Real* outVelocity, uint8_t* outValid, size_t count, double dtSeconds,
+               HashAccumulator* hash = nullptr, uint32_t hashIndex = 0); // Dispatching entry point.
+
+inline void integrate(Real* position, Real* velocity, uint8_t* valid, size_t count, double dtSeconds,
+                      HashAccumulator* hash = nullptr, uint32_t hashIndex = 0) { // In place.
+    integrate(position, velocity, valid, position, velocity, valid, count, dtSeconds, hash, hashIndex);
+}
+
+// Batch presentation blend: out = prev * (1 - alpha) + curr * alpha for position and velocity.
+// Same contract as above: one subtract for the weight, two multiplies and one add per value, no FMA,
+// so every kernel produces bit-identical frames. Output arrays must not alias the inputs.
+// Fixed point: the same formula with scaleReal() and alpha in [0, 1]; every kind runs the scalar blend.
+using InterpolateFn = void (*)(const Real* prevPosition, const Real* prevVelocity,
+                               const Real* currPosition, const Real* currVelocity,
+                               Real* outPosition, Real* outVelocity, size_t count, double alpha);
+
+void interpolateScalar(const Real* prevPosition, const Real* prevVelocity, const Real* currPosition,
+                       const Real* currVelocity, Real* outPosition, Real* outVelocity, size_t count, double alpha);
+void interpolateAvx2(const Real* prevPosition, const Real* prevVelocity, const Real* currPosition,
+                     const Real* currVelocity, Real* outPosition, Real* outVelocity, size_t count, double alpha);
+void interpolateAvx512(const Real* prevPosition, const Real* prevVelocity, const Real* currPosition,
+                       const Real* currVelocity, Real* outPosition, Real* outVelocity, size_t count, double alpha);
+
+void interpolate(const Real* prevPosition, const Real* prevVelocity, const Real* currPosition,
+                 const Real* currVelocity, Real* outPosition, Real* outVelocity, size_t count,
+                 double alpha);                  // Dispatching entry point; same kernel family as integrate().
+
+#endif // INTEGRATOR_H
@@ -0,0 +1,72 @@
+#include "interest.h"
+
+#include <algorithm>
+
+void InterestRegistry::configure(size_t entityCount) {
+    std::lock_guard<std::mutex> guard(lock_);
+    entityCount_ = entityCount;
+    marks_.assign(entityCount, 0);
+    union_.clear();
+    union_.reserve(entityCount);
+    for (std::vector<uint32_t>& set : sets_) {   // A smaller world drops what no longer exists.
+        set.erase(std::remove_if(set.begin(), set.end(), [&](uint32_t e) { return e >= entityCount; }), set.end());
+    }
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+int InterestRegistry::subscribe(const std::vector<uint32_t>& entities) {
+    std::lock_guard<std::mutex> guard(lock_);
+    size_t handle = 0;
+    while (handle < live_.size() && live_[handle]) ++handle; // Reuse a freed slot.
+    if (handle == live_.size()) {
+        sets_.emplace_back();
+        live_.push_back(false);
+    }
+    live_[handle] = true;
+    sets_[handle].clear();
+    for (uint32_t entity : entities) {
+        if (entity < entityCount_) sets_[handle].push_back(entity);
+    }
+    version_.fetch_add(1, std::memory_order_release);
+    return static_cast<int>(handle);
+}
+
+void InterestRegistry::update(int handle, const std::vector<uint32_t>& entities) {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (handle < 0 || static_cast<size_t>(handle) >= live_.size() || !live_[handle]) return;
+    std::vector<uint32_t>& set = sets_[handle];
+    set.clear();
+    for (uint32_t entity : entities) {
+        if (entity < entityCount_) set.push_back(entity);
+    }
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+void InterestRegistry::unsubscribe(int handle) {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (handle < 0 || static_cast<size_t>(handle) >= live_.size()) return;
+    live_[handle] = false;
+    sets_[handle].clear();
+    version_.fetch_add(1, std::memory_order_release);
+}
+
+const std::vector<uint32_t>& InterestRegistry::observed() {
+    const uint64_t version = version_.load(std::memory_order_acquire);
+    if (version == builtVersion_) return union_;
+    std::unique_lock<std::mutex> guard(lock_, std::try_to_lock);
+    if (!guard.owns_lock()) return union_;       // A consumer is mid-update: keep last frame's union.
+
+    union_.clear();
+    for (size_t handle = 0; handle < sets_.size(); ++handle) {
+        if (!live_[handle]) continue;
+        for (uint32_t entity : sets_[handle]) {
+            if (marks_[entity]) continue;
+            marks_[entity] = 1;
+            union_.push_back(entity);
+        }
+    }
+    std::sort(union_.begin(), union_.end());     // In place; sorted output keeps the blend's reads ascending.
+    for (uint32_t entity : union_) marks_[entity] = 0;
+    builtVersion_ = version_.load(std::memory_order_relaxed); // Under the lock: nothing newer is half-applied.
+    return union_;
+}
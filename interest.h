@@ -0,0 +1,49 @@
+#ifndef INTEREST_H
+#define INTEREST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Interest management for the presentation layer. Consumers (viewports, watch-lists, telemetry)
+// register the entities they observe; each frame the sim thread interpolates only the union of
+// those sets, so presentation cost scales with what is observed, not with the world.
+//
+// Consumers subscribe, update and unsubscribe from any thread; those calls take a mutex and may
+// allocate. The sim thread rebuilds the union only after a change, and only with try_lock: if a
+// consumer holds the lock, the previous union is used for one more frame. The rebuild is
+// O(observed log observed) into buffers sized by configure(), so the frame loop never waits and
+// never allocates here.
+
+class InterestRegistry {
+public:
+    InterestRegistry() = default;
+
+    InterestRegistry(const InterestRegistry&) = delete;
+    InterestRegistry& operator=(const InterestRegistry&) = delete;
+
+    void configure(size_t entityCount);          // Sim thread, before consumers subscribe. Sizes the union buffers.
+
+    // Any thread. Entities outside the world are ignored; duplicates are fine. Returns the handle.
+    int subscribe(const std::vector<uint32_t>& entities);
+    void update(int handle, const std::vector<uint32_t>& entities);
+    void unsubscribe(int handle);
+
+    // Sim thread, once per frame: the union of all sets, sorted and unique.
+    const std::vector<uint32_t>& observed();
+
+private:
+    std::mutex lock_;                            // Guards sets_ and live_.
+    std::vector<std::vector<uint32_t>> sets_;    // Indexed by handle.
+    std::vector<bool> live_;
+    size_t entityCount_ = 0;
+    std::atomic<uint64_t> version_{0};           // Bumped on every change; checked without the lock.
+
+    uint64_t builtVersion_ = 0;                  // Sim thread only from here on.
+    std::vector<uint8_t> marks_;                 // Per entity: already in union_. Cleared after each rebuild.
+    std::vector<uint32_t> union_;                // Capacity entityCount: push_back never reallocates.
+};
+
+#endif // INTEREST_H
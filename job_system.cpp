@@ -0,0 +1,108 @@
+#include "job_system.h"
+
+#include <cstdio>
+
+#include "trace.h"
+
+namespace {
+const size_t JOBS_PER_THREAD = 8;                // Enough slack for stealing to even out uneven ranges.
+}
+
+JobSystem::JobSystem(unsigned threadCount)
+    : queues_(threadCount > 1 ? threadCount : 1) {
+    for (size_t i = 1; i < queues_.size(); ++i) {
+        workers_.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(wakeLock_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& worker : workers_) worker.join();
+}
+
+void JobSystem::parallelFor(size_t count, size_t minRange, JobFn fn, void* context) {
+    if (count == 0) return;
+    if (minRange == 0) minRange = 1;
+    const size_t participants = queues_.size();
+    if (participants == 1) {                     // No workers: skip the queues entirely.
+        fn(context, 0, count);
+        return;
+    }
+
+    size_t jobCount = (count + minRange - 1) / minRange;
+    size_t maxJobs = participants * (JOBS_PER_THREAD < MAX_JOBS_PER_QUEUE ? JOBS_PER_THREAD : MAX_JOBS_PER_QUEUE);
+    if (jobCount > maxJobs) jobCount = maxJobs;
+    size_t rangeSize = (count + jobCount - 1) / jobCount;
+    rangeSize = (rangeSize + minRange - 1) / minRange * minRange; // Ranges stay multiples of minRange.
+    jobCount = (count + rangeSize - 1) / rangeSize;
+
+    pending_.store(jobCount, std::memory_order_relaxed);
+    for (size_t j = 0; j < jobCount; ++j) {      // Deal round-robin; stealing fixes any imbalance.
+        WorkQueue& queue = queues_[j % participants];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        size_t begin = j * rangeSize;
+        size_t end = begin + rangeSize < count ? begin + rangeSize : count;
+        queue.jobs[queue.tail++ % MAX_JOBS_PER_QUEUE] = Job{fn, context, begin, end};
+    }
+    {
+        std::lock_guard<std::mutex> guard(wakeLock_);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    while (pending_.load(std::memory_order_acquire) != 0) { // Barrier: caller works too, then waits for stragglers.
+        if (!runOne(0)) std::this_thread::yield();
+    }
+}
+
+bool JobSystem::popOwn(size_t index, Job& job) {
+    WorkQueue& queue = queues_[index];
+    std::lock_guard<std::mutex> guard(queue.lock);
+    if (queue.head == queue.tail) return false;
+    job = queue.jobs[--queue.tail % MAX_JOBS_PER_QUEUE]; // LIFO for the owner.
+    return true;
+}
+
+bool JobSystem::steal(size_t thief, Job& job) {
+    const size_t participants = queues_.size();
+    for (size_t offset = 1; offset < participants; ++offset) {
+        WorkQueue& victim = queues_[(thief + offset) % participants];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.head == victim.tail) continue;
+        job = victim.jobs[victim.head++ % MAX_JOBS_PER_QUEUE]; // FIFO for thieves: takes the oldest, coldest work.
+        return true;
+    }
+    return false;
+}
+
+bool JobSystem::runOne(size_t index) {
+    Job job;
+    if (!popOwn(index, job) && !steal(index, job)) return false;
+    job.fn(job.context, job.begin, job.end);
+    pending_.fetch_sub(1, std::memory_order_acq_rel); // Release: job's writes visible to whoever sees pending_ == 0.
+    return true;
+}
+
+void JobSystem::workerLoop(size_t index) {
+    if (traceEnabled()) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "worker %zu", index);
+        traceThreadName(name);
+    }
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> guard(wakeLock_);
+            wake_.wait(guard, [&] { return stopping_ || generation_ != seenGeneration; });
+            if (stopping_) return;
+            seenGeneration = generation_;
+        }
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            if (!runOne(index)) std::this_thread::yield(); // Others still running; their queues may refill next round.
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "command_queue.h"
+
+// Work-stealing thread pool for data-parallel passes over the entity store.
+//
+// parallelFor() cuts [0, count) into jobs, deals them round-robin into per-participant deques and
+// returns only when every job has finished (the barrier before the next step). Each participant
+// pops its own deque from the back (hot, recently pushed work) and, when empty, steals from the
+// front of the others. The calling thread participates, so a pool of 1 is plain inline execution.
+//
+// Determinism is the caller's contract, not the pool's: jobs must write disjoint data and any
+// reduction must be indexed by a fixed decomposition (e.g. hash block), never by thread or job.
+// Then results are identical on 1 or 64 cores.
+//
+// Jobs are plain function pointer + context + range: no std::function, no allocation per call.
+
+using JobFn = void (*)(void* context, size_t begin, size_t end);
+
+class JobSystem {
+public:
+    explicit JobSystem(unsigned threadCount);    // Total participants including the caller; 0 or 1 = no workers.
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // Runs fn over [0, count) in ranges of at least minRange; blocks until all ranges are done.
+    void parallelFor(size_t count, size_t minRange, JobFn fn, void* context);
+    unsigned threadCount() const { return static_cast<unsigned>(queues_.size()); }
+
+private:
+    struct Job {
+        JobFn fn;
+        void* context;
+        size_t begin;
+        size_t end;
+    };
+
+    static const size_t MAX_JOBS_PER_QUEUE = 64; // Jobs per participant per parallelFor; bounds queue memory.
+
+    struct alignas(CACHE_LINE_SIZE) WorkQueue {  // Fixed-capacity deque; a short lock per push/pop/steal.
+        std::mutex lock;
+        Job jobs[MAX_JOBS_PER_QUEUE];
+        size_t head = 0;                         // Thieves take from here.
+        size_t tail = 0;                         // Owner pushes/pops here.
+    };
+
+    bool popOwn(size_t index, Job& job);
+    bool steal(size_t thief, Job& job);
+    bool runOne(size_t index);                   // Pop or steal one job and run it. False if nothing was found.
+    void workerLoop(size_t index);
+
+    std::vector<WorkQueue> queues_;              // queues_[0] belongs to the calling thread.
+    std::vector<std::thread> workers_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> pending_{0}; // Jobs of the current parallelFor not yet finished.
+    std::mutex wakeLock_;
+    std::condition_variable wake_;
+    uint64_t generation_ = 0;                    // Bumped per parallelFor; guarded by wakeLock_.
+    bool stopping_ = false;
+};
+
+#endif // JOB_SYSTEM_H
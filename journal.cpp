@@ -0,0 +1,113 @@
+#include "journal.h"
+
+#include <cstring>
+
+namespace {
+const size_t JOURNAL_BUFFER_BYTES = 1 << 20;     // 1 MiB: tens of thousands of steps between writes.
+}
+
+JournalWriter::~JournalWriter() {
+    if (file_) std::fclose(file_);               // No end marker: reader falls back to the last recorded tick.
+}
+
+bool JournalWriter::open(const char* path) {
+    file_ = std::fopen(path, "wb");
+    if (!file_) return false;
+    buffer_.resize(JOURNAL_BUFFER_BYTES);
+    std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+
+    JournalFileHeader header;
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.maxCommandsPerStep = static_cast<uint16_t>(MAX_COMMANDS_PER_STEP);
+    std::fwrite(&header, sizeof(header), 1, file_);
+    return true;
+}
+
+void JournalWriter::append(uint64_t tick, const Command* commands, size_t count) {
+    if (!file_ || count == 0) return;            // Empty steps cost nothing on disk.
+
+    JournalEntryHeader entry{tick, static_cast<uint32_t>(count), 0};
+    std::fwrite(&entry, sizeof(entry), 1, file_);
+    for (size_t i = 0; i < count; ++i) {
+        JournalCommand record{};
+        record.type = static_cast<uint8_t>(commands[i].type);
+        record.entity = commands[i].entity;
+        record.value = commands[i].value;
+        std::fwrite(&record, sizeof(record), 1, file_);
+    }
+}
+
+void JournalWriter::close(uint64_t endTick) {
+    if (!file_) return;
+    JournalEntryHeader marker{endTick, 0, 0};
+    std::fwrite(&marker, sizeof(marker), 1, file_);
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool JournalReader::open(const char* path) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return false;
+
+    JournalFileHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+              && std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0
+              && (header.version == 1 || header.version == JOURNAL_VERSION)
+              && header.maxCommandsPerStep <= MAX_COMMANDS_PER_STEP; // Recorded batches must fit this build's step.
+
+    JournalEntryHeader entry;
+    bool sawEndMarker = false;
+    while (ok && std::fread(&entry, sizeof(entry), 1, file) == 1) {
+        if (entry.count == 0) {                  // End marker.
+            endTick_ = entry.tick;
+            sawEndMarker = true;
+            break;
+        }
+        if ((header.version == 1 && entry.count > header.maxCommandsPerStep)
+            || (!entries_.empty() && entry.tick <= entries_.back().tick)) {
+            ok = false;                          // Corrupt: oversized batch or non-monotonic ticks.
+            break;
+        }
+        entries_.push_back(Entry{entry.tick, static_cast<uint32_t>(commands_.size()), entry.count});
+        uint32_t broadcasts = 0;
+        uint32_t lastEntity = 0;
+        bool targeted = false;
+        for (uint32_t i = 0; ok && i < entry.count; ++i) {
+            JournalCommand record;
+            if (std::fread(&record, sizeof(record), 1, file) != 1
+                || record.type > static_cast<uint8_t>(CommandType::Stop)) {
+                ok = false;
+                break;
+            }
+            Command command{static_cast<CommandType>(record.type), record.value};
+            if (header.version >= 2) command.entity = record.entity;
+            if (command.entity == ALL_ENTITIES) {
+                ok = !targeted && ++broadcasts <= header.maxCommandsPerStep; // Broadcasts form a bounded prefix.
+            } else {
+                ok = !targeted || command.entity >= lastEntity; // Targeted part must be sorted by entity.
+                targeted = true;
+                lastEntity = command.entity;
+            }
+            commands_.push_back(command);
+        }
+    }
+    std::fclose(file);
+
+    if (ok && !sawEndMarker) {                   // Truncated capture (crash, kill -9): replay what we have.
+        endTick_ = entries_.empty() ? 0 : entries_.back().tick + 1;
+    }
+    loaded_ = ok;
+    return ok;
+}
+
+size_t JournalReader::commandsForTick(uint64_t tick, const Command*& commands) {
+    while (cursor_ < entries_.size() && entries_[cursor_].tick < tick) {
+        ++cursor_;                               // Skip entries for ticks the caller has already passed.
+    }
+    if (cursor_ == entries_.size() || entries_[cursor_].tick != tick) return 0;
+
+    const Entry& entry = entries_[cursor_++];
+    commands = commands_.data() + entry.first;
+    return entry.count;
+}
@@ -0,0 +1,90 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "simulation.h"
+
+// Record/replay journal of the consumed command stream.
+// The engine is deterministic given its initial state and the commands applied at each tick, so
+// journaling exactly those (after coalescing, keyed by tick index, one entry per step that applied anything) is enough
+// to reproduce a run bit-for-bit offline, at headless speed, without any of the original input.
+//
+// File layout (host byte order):
+//   JournalFileHeader
+//   { JournalEntryHeader, JournalCommand[count] }*   - ticks with count == 0 are omitted
+//   JournalEntryHeader with count == 0              - end marker; tick = total ticks run (optional)
+// An entry holds the step's broadcast commands first (at most maxCommandsPerStep), then its
+// entity-targeted commands sorted by entity: exactly the two arrays stepSimulation() was given.
+
+const char JOURNAL_MAGIC[4] = {'C', '2', 'J', 'R'};
+const uint16_t JOURNAL_VERSION = 2;              // 2: commands carry a target entity. Version 1 files replay as broadcasts.
+
+struct JournalFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t maxCommandsPerStep;                 // Broadcast batching the run was recorded with.
+};
+
+struct JournalEntryHeader {
+    uint64_t tick;                               // sim.tick before the step that consumed these commands.
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct JournalCommand {                          // Explicit on-disk form; decoupled from the in-memory Command layout.
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t entity;                             // ALL_ENTITIES for broadcasts. Zero (reserved) in version 1.
+    double value;
+};
+
+static_assert(sizeof(JournalFileHeader) == 8, "journal header layout changed");
+static_assert(sizeof(JournalEntryHeader) == 16, "journal entry layout changed");
+static_assert(sizeof(JournalCommand) == 16, "journal command layout changed");
+
+class JournalWriter {
+public:
+    JournalWriter() = default;
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    bool open(const char* path);
+    bool isOpen() const { return file_ != nullptr; }
+    void append(uint64_t tick, const Command* commands, size_t count); // Sim thread, once per step. Buffered; no-op if count == 0.
+    void close(uint64_t endTick);                // Writes the end marker so replay knows how long the run was.
+
+private:
+    std::FILE* file_ = nullptr;
+    std::vector<char> buffer_;                   // stdio buffer; large so appends are memcpy, not syscalls.
+};
+
+class JournalReader {
+public:
+    bool open(const char* path);                 // Loads the whole journal; false on missing or malformed file.
+    bool isOpen() const { return loaded_; }
+
+    // The commands recorded for tick (broadcasts first, then targeted sorted by entity); points into the
+    // loaded journal. Ticks must be requested in increasing order.
+    size_t commandsForTick(uint64_t tick, const Command*& commands);
+    uint64_t endTick() const { return endTick_; } // Ticks the recorded run covered.
+
+private:
+    struct Entry {
+        uint64_t tick;
+        uint32_t first;                          // Index into commands_.
+        uint32_t count;
+    };
+
+    std::vector<Entry> entries_;
+    std::vector<Command> commands_;
+    size_t cursor_ = 0;
+    uint64_t endTick_ = 0;
+    bool loaded_ = false;
+};
+
+#endif // JOURNAL_H
@@ -1,155 +1,443 @@
 
 #include <iostream>
-#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <atomic>
 #include <cstdint>
-#include <thread>
-#include <deque>
+#include <optional>
+#include <algorithm>
+#include <vector>
+
+#include "alloc_guard.h"
+#include "arena.h"
+#include "clock.h"
+#include "command_pipeline.h"
+#include "command_queue.h"
+#include "engine.h"
+#include "frame_pacer.h"
+#include "frame_stats.h"
+#include "integrator.h"
+#include "interest.h"
+#include "job_system.h"
+#include "journal.h"
+#include "presentation.h"
+#include "simulation.h"
+#include "snapshot.h"
+#include "state_hash.h"
+#include "telemetry.h"
+#include "trace.h"
 
 using namespace std;
-using namespace std::chrono;
 
 // System architecture: monotonic time, dt clamp, fixed-step accumulation, interpolation, load control & stability.
 // Three-layer design: real-time measurement, simulation time, presentation time.
 
-const double MAX_DT_SECONDS = 0.05;              // Typical real-time systems use 10-50ms. (dt clamping)
-const double FIXED_DT_SECONDS = 0.01;            // Simulation tick. Deterministic, predictable, testable. (fixed step accumulation)
-const int MAX_SIMULATION_STEPS_PER_FRAME = 5;    // Hard safety cap. Prevents infinite catch-up if system lags. (load control & stability)
-// Without this: lag -> more steps -> more CPU -> more lag -> death spiral.
-// With this: simulation is bounded, CPU is capped, system degrades gracefully.
+CommandQueue commandQueue;                       // Broadcast commands. Lock-free MPSC ring: any thread feeds it, only the tick loop drains it.
+CommandScheduler scheduler;                      // Drained broadcasts waiting for their targetTick.
+CommandRouter router;                            // Entity-targeted commands: per-partition queues and schedulers.
 
-const size_t MAX_COMMAND_QUEUE_SIZE = 32;        // Hard upper bound for input pressure. Prevents unbounded memory growth.
+const int64_t NANOS_PER_SECOND = 1000000000;    // Always use int64_t for time: explicit width, overflow-safe.
 
-enum class CommandType {                         // Represents "intent" coming from UI, network or sensors.
-    Accelerate, Stop
-};
+SteadyClock steadyClock;                         // --clock: the run's single time source, chosen once at startup.
+TscClock tscClock;
+VirtualClock virtualClock;
+Clock* timeSource = &steadyClock;                // Monotonic ns; only differences are meaningful.
+FrameStats frameStats;                           // Per-layer latency histograms; readable from any thread.
 
-struct Command {                                 // Small, copyable, time-agnostic instruction. Safe to queue or batch.
-    CommandType type;
-    double value;                                // Parameter for the command (acceleration magnitude).
-};
+TelemetrySink telemetry;                         // Presentation output; binary, asynchronous, never blocks the frame loop.
+InterestRegistry interest;                       // Which entities presentation consumers observe; any thread may subscribe.
 
-std::deque<Command> commandQueue;                // Chosen for stable pointers, fast push/pop, and good cache behavior.
-
-int64_t nowMs() {                                // Always use int64_t for time: explicit width, overflow-safe.
-    return chrono::duration_cast<chrono::milliseconds>(
-               chrono::steady_clock::now().time_since_epoch()
-               ).count();
-    // 1. Returns a monotonic, relative millisecond timestamp (not wall-clock time).
-    // 2. steady_clock never goes backwards and is not affected by system time changes.
-    // 3. time_since_epoch() is relative to an arbitrary start point; only differences are meaningful.
-    // 4. duration_cast makes time unit conversion explicit and prevents hidden precision loss.
-    // 5. count() extracts the raw integer value of the duration.
-    // Suitable for simulation ticks, scheduling, and causal ordering in real-time systems.
+std::atomic<uint64_t> commandsDropped{0};        // Rejected by a full queue or unknown entity; any producer thread.
+CommandDrainStats broadcastStats;                // Broadcasts drained by the tick loop, and those the scheduler rejected.
+uint64_t commandsApplied = 0;                    // Left after coalescing; what applyCommand actually ran.
+
+bool enqueueCommand(const Command& cmd) {        // UI/Input boundary. Callable from any thread; does not touch simulation state.
+    bool queued = cmd.entity == ALL_ENTITIES ? commandQueue.tryPush(cmd) : router.enqueue(cmd); // Targeted: own partition's ring.
+    if (queued) return true;
+    commandsDropped.fetch_add(1, std::memory_order_relaxed); // If queue is full, drop command (Overload protection policy).
+    return false;
 }
 
-struct SystemState {
-    double position;                             // Continuous state variable; example of a physical property.
-    double velocity;                             // Rate of change of position; essential for integration.
-    bool valid;                                  // Data validity flag; simulation stops evolving when false.
-};
+JournalWriter journal;                           // --record: every consumed command, keyed by tick.
+JournalReader replay;                            // --replay: recorded commands replace live input.
+HashLogWriter hashLog;                           // --hash-log: per-tick state checksum stream.
+SnapshotWriter snapshots;                        // Forked copy-on-write checkpoints.
+JobSystem* jobs = nullptr;                       // --threads: work-stealing pool for the fixed step; null = inline.
 
-void updateSystem(SystemState& state, double dtSeconds) {
-    if (!state.valid) return;                    // Invalid systems don't evolve.
-    state.position += state.velocity * dtSeconds; // Integrate position.
+const size_t TICK_ARENA_BYTES = 512 * 1024;      // Per-tick scratch budget; reset at the start of every step.
+const uint64_t ALLOC_GUARD_WARMUP_FRAMES = 8;    // Frames and ticks; first-use allocations (trace rings, hash blocks) happen before this.
+FrameArena tickArena(TICK_ARENA_BYTES);          // Scratch for one step: no heap traffic inside the loop.
+static_assert((MAX_APPLIED_COMMANDS_PER_STEP + MAX_RELEASED_COMMANDS_PER_STEP) * sizeof(Command) + 2 * alignof(Command) <= TICK_ARENA_BYTES,
+              "tick arena too small for a step's command batches");
 
-    if (state.position < 0.0) {                  // Prevent physically impossible negative position.
-        state.position = 0.0;
-        state.velocity = 0.0;
-        state.valid = false;                     // Mark state invalid; logical failure protection.
-    }
+volatile sig_atomic_t stopRequested = 0;         // Set by SIGINT/SIGTERM; lets the loop exit and close its outputs.
+volatile sig_atomic_t snapshotRequested = 0;     // Set by SIGUSR1; checkpoint on demand.
+volatile sig_atomic_t traceDumpRequested = 0;    // Set by SIGUSR2; write the trace rings now.
+
+void requestStop(int) {
+    stopRequested = 1;
 }
 
-bool enqueueCommand(const Command& cmd) {        // UI/Input boundary. Can be called anytime; does not touch simulation state.
-    if (commandQueue.size() >= MAX_COMMAND_QUEUE_SIZE) {
-        return false;                            // If queue is full, drop command (Overload protection policy).
-    }
-    commandQueue.push_back(cmd);                 // Add command to queue.
-    return true;
+void requestSnapshot(int) {
+    snapshotRequested = 1;
 }
 
-void applyCommand(SystemState& state, const Command& cmd) {
-    if (!state.valid) return;                    // Invalid systems do not accept commands.
-    switch(cmd.type) {
-    case CommandType::Accelerate:                // Adjust velocity, not position. Physics integration happens in updateSystem().
-        state.velocity += cmd.value;
-        break;
-    case CommandType::Stop:                      // Immediate velocity cancellation. Deterministic in fixed-step context.
-        state.velocity = 0.0;
-        break;
-    }
+void requestTraceDump(int) {
+    traceDumpRequested = 1;
 }
 
-SystemState interpolateState(const SystemState& prev, const SystemState& curr, double alpha) {
-    SystemState out = curr;                      // Interpolating function for display layer.
-    out.position = prev.position * (1.0 - alpha) + curr.position * alpha;
-    out.velocity = prev.velocity * (1.0 - alpha) + curr.velocity * alpha;
-    return out;
+StepCommands commandsForStep(uint64_t tick) {    // Commands for one step. Same drain in every run mode.
+    TRACE_SCOPE("drainCommands");
+    tickArena.reset();                           // Last step's scratch is dead.
+    StepCommands step;
+    if (replay.isOpen()) {
+        const Command* recorded = nullptr;
+        const size_t count = replay.commandsForTick(tick, recorded); // Recorded batches are already coalesced and sorted.
+        size_t broadcasts = 0;
+        while (broadcasts < count && recorded[broadcasts].entity == ALL_ENTITIES) ++broadcasts;
+        step = StepCommands{recorded, broadcasts, recorded + broadcasts, count - broadcasts};
+    } else {
+        Command* batch = tickArena.allocateArray<Command>(MAX_APPLIED_COMMANDS_PER_STEP);
+        Command* released = tickArena.allocateArray<Command>(MAX_RELEASED_COMMANDS_PER_STEP);
+        step = drainCommands(tick, commandQueue, scheduler, router, batch, released, broadcastStats, jobs);
+    }
+    const size_t count = step.broadcastCount + step.targetedCount; // Broadcasts and targeted are contiguous.
+    commandsApplied += count;
+    journal.append(tick, step.broadcast, count); // What was applied, post-coalescing; no-op unless recording.
+    return step;
 }
 
-int main() {
-    SystemState currentState {0.0, 1.0, true};
-    SystemState previousState;
-    int64_t lastTickMs = nowMs();
-    double timeAccumulator = 0.0;                // Buffer for unprocessed real time. Prevents time loss and instability.
+struct QueueCommandPolicy {                      // Live queues, scheduler and router, or the --replay journal.
+    StepCommands drain(uint64_t tick) { return commandsForStep(tick); } // Lock-free drains, no shared queue between partitions.
+};
 
-    while (true) {                               // Infinite loop: continuous operation like C2 or sensor processing loops.
+struct ParallelStepIntegrator {                  // Apply commands and integrate (the deterministic core), then checksum.
+    void step(SimulationState& sim, const StepCommands& commands) {
+        stepSimulation(sim, commands.broadcast, commands.broadcastCount,
+                       commands.targeted, commands.targetedCount, jobs); // Block-parallel on --threads.
+        if (sim.hashEnabled) hashLog.append(sim.tick, sim.stateHash);
+    }
+};
 
-        // --- LAYER 1: TEMPORAL MEASUREMENTS (INPUT LAYER) ---
-        int64_t now = nowMs();                   // Sample time once per loop.
-        int64_t dtMs = now - lastTickMs;         // Elapsed time since last loop; drives physics and scheduling.
-        lastTickMs = now;                        // Update temporal anchor to prevent dt accumulation errors.
-        double dtSeconds = dtMs / 1000.0;        // Convert to seconds (canonical unit for physics evolution).
+// Clock is the interface: --clock picks the backend at runtime, and one virtual call per frame is noise.
+using Engine = SimulationEngine<SimulationState, ParallelStepIntegrator, QueueCommandPolicy, Clock, DefaultEngineConfig>;
+QueueCommandPolicy commandPolicy;
+ParallelStepIntegrator stepIntegrator;
+
+void reportFinalState(ostream& out, const char* mode, SimulationState& sim, int64_t wallStart) {
+    syncState(sim, jobs);                        // Deferred blocks replay up to sim.tick before anything is read.
+    const double wallSeconds = static_cast<double>(timeSource->nowNs() - wallStart) / NANOS_PER_SECOND; // Replay included.
+    SystemState track = sim.current.get(0);
+    out << mode << " ticks=" << sim.tick << " simulated=" << sim.tick * sim.stepSeconds << "s wall=" << wallSeconds
+        << "s pos=" << track.position << " vel=" << track.velocity << " valid=" << track.valid
+        << " hash=" << hex << hashState(sim.current) << dec << endl; // Whole-world fingerprint; compare across runs.
+}
 
-        // --- LAYER 2: SECURITY GATE (CLAMPING) ---
-        if (dtSeconds > MAX_DT_SECONDS) {        // Protect simulation from exploding if real time jumps.
-            dtSeconds = MAX_DT_SECONDS;          // This is the clamp; throw away excess real time.
-        }
-        timeAccumulator += dtSeconds;            // Track total usable time (Measurement != Simulation).
+uint64_t snapshotEvery = 0;                      // Copied from RunOptions; read between steps.
+const char* snapshotPath = nullptr;
+uint64_t nextSnapshotTick = 0;
+
+void maybeSnapshot(SimulationState& sim) {       // Between steps only: the state must be consistent.
+    snapshots.poll();
+    bool periodic = snapshotEvery > 0 && sim.tick >= nextSnapshotTick;
+    if (!periodic && !snapshotRequested) return;
+    snapshotRequested = 0;
+    if (periodic) nextSnapshotTick = (sim.tick / snapshotEvery + 1) * snapshotEvery;
+    syncState(sim, jobs);                        // The checkpoint holds the world at sim.tick, deferred blocks included.
+    snapshots.begin(snapshotPath, sim, commandQueue, scheduler, router); // Fork and return; the child does the I/O.
+}
 
-        int stepsThisFrame = 0;
+const char* tracePath = nullptr;                 // Copied from RunOptions; null = tracing off.
 
-        // --- LAYER 3: DETERMINISTIC ENGINE (SIMULATION LAYER) ---
-        while (timeAccumulator >= FIXED_DT_SECONDS && stepsThisFrame < MAX_SIMULATION_STEPS_PER_FRAME) {
-            previousState = currentState;        // Backup state before update to allow for interpolation.
+void maybeDumpTrace() {                          // On the frame loop: the dump's I/O shows up as one long frame.
+    if (!traceDumpRequested || !tracePath) return;
+    traceDumpRequested = 0;
+    AllocationPermit permit;                     // The dump builds its copy of the rings on the heap.
+    if (!traceDump(tracePath)) cerr << "cannot write trace " << tracePath << endl;
+}
 
-            const int MAX_COMMANDS_PER_STEP = 4; // Limit commands per step to prevent physics starvation.
-            int processed = 0;
-            while (!commandQueue.empty() && processed < MAX_COMMANDS_PER_STEP) {
-                applyCommand(currentState, commandQueue.front()); // Process commands deterministically (FIFO).
-                commandQueue.pop_front();
-                processed++;
-            }
+struct RunOptions {
+    const char* telemetryPath = "telemetry.bin"; // Decode with tools/telemetry_decode; "-" streams to stdout.
+    const char* recordPath = nullptr;            // Command journal output.
+    const char* replayPath = nullptr;            // Command journal input; implies headless.
+    const char* hashLogPath = nullptr;           // Per-tick checksum stream output.
+    const char* snapshotPath = "snapshot.c2s";   // Where checkpoints go (SIGUSR1 or --snapshot-every).
+    uint64_t snapshotEvery = 0;                  // Ticks between periodic checkpoints; 0 = on demand only.
+    unsigned threads = 1;                        // Participants in the fixed step (including the sim thread).
+    double framesPerSecond = 62.5;               // Presentation rate; 62.5 = the historical 16 ms frame.
+    const char* tracePath = nullptr;             // Chrome Trace JSON; written on SIGUSR2 and at exit.
+    const char* clockName = "steady";            // steady | tsc | virtual.
+    const char* restorePath = nullptr;           // Start from a checkpoint instead of the initial state.
+    const char* watchList = "0";                 // Entities the telemetry presenter observes: "0,7,100-199".
+    bool headless = false;                       // Batch mode: no pacing, no clamp, no presentation.
+    uint64_t headlessTicks = 0;                  // 0 with --replay: run as long as the recording.
+};
 
-            updateSystem(currentState, FIXED_DT_SECONDS); // Source of truth; advances physics in fixed 10ms slices.
-            timeAccumulator -= FIXED_DT_SECONDS;          // Spend the simulated time.
-            stepsThisFrame++;
+// "a,b,c-d": indices and inclusive ranges. Every index must be below entityCount (and fit a uint32_t),
+// which also bounds what one range can allocate.
+bool parseEntityList(const char* text, size_t entityCount, std::vector<uint32_t>& entities) {
+    const unsigned long long limit = std::min<unsigned long long>(entityCount, 1ULL << 32);
+    entities.clear();
+    while (*text) {
+        if (*text < '0' || *text > '9') return false; // strtoull would take a sign or spaces.
+        char* end = nullptr;
+        const unsigned long long first = std::strtoull(text, &end, 10);
+        if (first >= limit) return false;        // Also catches ERANGE (ULLONG_MAX).
+        unsigned long long last = first;
+        if (*end == '-') {
+            text = end + 1;
+            if (*text < '0' || *text > '9') return false;
+            last = std::strtoull(text, &end, 10);
+            if (last < first || last >= limit) return false;
         }
+        for (unsigned long long entity = first; entity <= last; ++entity) entities.push_back(static_cast<uint32_t>(entity));
+        if (*end == ',') ++end;
+        else if (*end) return false;
+        text = end;
+    }
+    return true;
+}
 
-        if (stepsThisFrame == MAX_SIMULATION_STEPS_PER_FRAME) {
-            timeAccumulator = 0.0;               // If overloaded, discard excess time to prevent spiral-of-death.
-        }
+int runRealTime(SimulationState& sim, double framesPerSecond, const std::vector<uint32_t>& watch) {
+    interest.configure(sim.current.size());      // After any restore: sized for the world being run.
+    PresentationBuffer presentation(sim.current.size()); // Both frames sized before the loop starts.
+    Presenter presenter;                         // Turns published frames into telemetry on its own thread.
+    presenter.start(presentation, telemetry, interest, watch); // Registers watch as its observed set.
+    FramePacer pacer(framesPerSecond);           // Absolute frame boundaries: work time is absorbed, not added.
+    Engine engine(sim, stepIntegrator, commandPolicy, *timeSource);
+    const int64_t wallStart = timeSource->nowNs();
+    std::optional<AllocationGuard> allocGuard;   // SIM_ALLOC_GUARD builds: abort on any heap allocation after warm-up.
+    uint64_t frame = 0;
+    engine.start();
+    pacer.start();
+
+    while (!stopRequested) {                     // Continuous operation like C2 or sensor processing loops, until SIGINT/SIGTERM.
+        ++frame;                                 // Arm after warm-up frames *and* ticks: above ~100 fps, early frames run no step.
+        if (!allocGuard && frame >= ALLOC_GUARD_WARMUP_FRAMES && sim.tick >= ALLOC_GUARD_WARMUP_FRAMES) allocGuard.emplace();
+        TRACE_SCOPE("frame");
+
+        // --- LAYERS 1-3: MEASUREMENT, CLAMP, FIXED STEPS (engine.h) ---
+        const EngineFrame timing = engine.advanceFrame();
+        frameStats.record(FrameLayer::Measurement, timing.measuredNs - timing.nowNs);
+        frameStats.record(FrameLayer::Clamp, timing.clampedNs - timing.measuredNs);
+        if (timing.overloaded) frameStats.recordOverloadDiscard();
+        maybeSnapshot(sim);                      // Frame boundary: accumulator and queue are consistent with the state.
+        frameStats.record(FrameLayer::Engine, timeSource->nowNs() - timing.clampedNs);
 
         for (int i = 0; i < 10; ++i) {           // Simulated UI/Input burst; does not belong to simulation layer.
             enqueueCommand(Command{CommandType::Accelerate, 0.1});
         }
+        enqueueCommand(Command{CommandType::Accelerate, 0.5, 0, // And one steered entity, via its partition.
+                               static_cast<uint32_t>(frame % sim.current.size())});
 
         // --- LAYER 4: PRESENTATION LAYER ---
-        double alpha = timeAccumulator / FIXED_DT_SECONDS; // Calculate fractional progress between ticks.
-        SystemState visualState = interpolateState(previousState, currentState, alpha); // Blend states for smooth visuals.
-
-        cout << "t =" << now << "ms dt=" << dtMs << " pos=" << visualState.position
-             << " vel=" << visualState.velocity << " valid=" << visualState.valid << endl;
+        const int64_t layerStart = timeSource->nowNs(); // The input burst above is not a layer; keep it out of the numbers.
+        const std::vector<uint32_t>& observed = interest.observed(); // Union of what consumers look at.
+        if (PresentationFrame* out = presentation.beginWrite()) { // Null: the reader still holds it; skip, never wait.
+            double alpha = engine.alpha();       // Calculate fractional progress between ticks.
+            out->count = observed.size();
+            std::copy(observed.begin(), observed.end(), out->entity.begin());
+            syncEntities(sim, observed.data(), observed.size()); // Fast-forwarded blocks catch up where watched.
+            interpolateSubset(sim.previous, sim.current, alpha, observed.data(), observed.size(), // Blend only what is
+                              out->state, jobs);   // observed: cost follows the viewers, not the world.
+            out->timeNs = timing.nowNs;
+            out->dtNs = timing.dtNs;
+            out->tick = sim.tick;
+            presentation.publish();              // One atomic store; the presenter thread does the rest.
+        }
+        frameStats.record(FrameLayer::Presentation, timeSource->nowNs() - layerStart);
 
-        this_thread::sleep_for(milliseconds(16)); // Limits update rate to prevent CPU hogging; introduces controlled latency.
+        if (timeSource == &virtualClock) {
+            virtualClock.advance(pacer.periodNs()); // Exactly one period per frame: a reproducible frame/tick schedule.
+        } else {
+            TRACE_SCOPE("pace");
+            pacer.waitForNextFrame();            // Sleep to just before the boundary, spin the rest; bounded latency, little CPU.
+        }
+        maybeDumpTrace();
 
         // Note on Stalls: If loop stalls (debugger/OS scheduling), dt becomes large.
         // Without clamping, a "time step explosion" occurs, breaking stability, causality, and safety.
         // Principle: Real time is measured continuously, but state must advance in controlled quanta.
     }
+    allocGuard.reset();
+    presenter.stop();
+
+    reportFinalState(cerr, "realtime", sim, wallStart);
+    PacerStats pacing = pacer.stats();
+    if (pacing.frames > 0) cerr << "pacer period=" << pacer.periodNs() / 1000 << "us frames=" << pacing.frames << " overruns=" << pacing.overruns
+         << " late(us) min=" << pacing.minLateNs / 1000.0 << " mean=" << pacing.meanLateNs / 1000.0
+         << " sd=" << pacing.stddevLateNs / 1000.0 << " max=" << pacing.maxLateNs / 1000.0 << endl;
+    frameStats.report(cerr);                     // Tail latency per layer; the SLA is stated in p99/p99.9.
+    cerr << "commands drained=" << broadcastStats.drained + router.drained() << " applied=" << commandsApplied
+         << " dropped=" << commandsDropped.load(std::memory_order_relaxed)
+         << " rejected=" << broadcastStats.rejected + router.rejected() << endl;
+    cerr << "presentation published=" << presentation.published() << " skipped=" << presentation.skipped()
+         << " presented=" << presenter.presented() << endl;
+    return 0;
+}
 
+int runHeadless(SimulationState& sim, uint64_t ticks) {
+    // Offline scenario evaluation: no wall-clock pacing, no dt clamp, no presentation.
+    // The accumulator is bypassed entirely; each iteration is exactly one fixed tick (Engine::FIXED_DT_NS) through
+    // the same Engine::step() as the real-time loop, so per-tick results are identical.
+    // With --clock virtual, time advances one fixed step per tick, so the reported time is simulated time.
+    Engine engine(sim, stepIntegrator, commandPolicy, *timeSource);
+    const int64_t wallStart = timeSource->nowNs();
+    std::optional<AllocationGuard> allocGuard;
+    for (uint64_t i = 0; i < ticks; ++i) {
+        if (i == ALLOC_GUARD_WARMUP_FRAMES) allocGuard.emplace();
+        engine.step();
+        maybeSnapshot(sim);
+        if (timeSource == &virtualClock) virtualClock.advance(Engine::FIXED_DT_NS);
+    }
+    allocGuard.reset();
+    reportFinalState(cout, replay.isOpen() ? "replay" : "headless", sim, wallStart);
     return 0;
 }
 
+int main(int argc, char* argv[]) {
+    RunOptions options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--telemetry") == 0 && i + 1 < argc) {
+            options.telemetryPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            options.headless = true;
+            options.headlessTicks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            options.replayPath = argv[++i];
+            options.headless = true;
+        } else if (std::strcmp(argv[i], "--hash-log") == 0 && i + 1 < argc) {
+            options.hashLogPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--snapshot-path") == 0 && i + 1 < argc) {
+            options.snapshotPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--snapshot-every") == 0 && i + 1 < argc) {
+            options.snapshotEvery = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--restore") == 0 && i + 1 < argc) {
+            options.restorePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--fps") == 0 && i + 1 < argc) {
+            const char* text = argv[++i];
+            char* end = nullptr;
+            options.framesPerSecond = std::strtod(text, &end);
+            if (end == text || *end != '\0' || !(options.framesPerSecond > 0.0)
+                || options.framesPerSecond > MAX_FRAMES_PER_SECOND) { // NaN fails the > 0 test too.
+                cerr << "--fps must be a number in (0, " << MAX_FRAMES_PER_SECOND << "], got " << text << endl;
+                return 2;
+            }
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            options.tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            options.clockName = argv[++i];
+        } else if (std::strcmp(argv[i], "--watch") == 0 && i + 1 < argc) {
+            options.watchList = argv[++i];
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            cerr << "usage: " << argv[0]
+                 << " [--telemetry PATH|-] [--headless TICKS] [--record JOURNAL] [--replay JOURNAL]"
+                 << " [--hash-log PATH] [--snapshot-path PATH] [--snapshot-every TICKS] [--restore PATH]"
+                 << " [--threads N] [--fps RATE] [--clock steady|tsc|virtual] [--trace PATH] [--watch LIST]" << endl;
+            return 2;
+        }
+    }
+    SimulationState sim(EntityStore(ENTITY_COUNT, SystemState{0.0, 1.0, true}));
+    sim.fastForward = true;                      // Idle blocks are deferred and replayed on demand; results are unchanged.
+    cerr << "integrator: " << integratorName(activeIntegrator()) << endl; // Once at startup; proves which kernel runs on this node.
+    if (std::strcmp(options.clockName, "tsc") == 0) {
+        if (tscClock.calibrate()) {
+            timeSource = &tscClock;
+        } else {
+            cerr << "clock: no invariant TSC, falling back to steady" << endl;
+        }
+    } else if (std::strcmp(options.clockName, "virtual") == 0) {
+        timeSource = &virtualClock;
+    } else if (std::strcmp(options.clockName, "steady") != 0) {
+        cerr << "unknown clock " << options.clockName << endl;
+        return 2;
+    }
+    cerr << "clock: " << timeSource->name();
+    if (timeSource == &tscClock) cerr << " (" << tscClock.ticksPerNs() << " GHz)";
+    cerr << endl;
+    tracePath = options.tracePath;
+    if (tracePath) {                             // Before the pool starts, so workers register their tracks.
+        // TSC when the CPU has one: ~40 ns per event instead of ~70 with steady_clock. Trace timestamps
+        // only need to agree with each other, so this is independent of --clock.
+        bool tscReady = timeSource == &tscClock || tscClock.calibrate();
+        traceEnable(tscReady ? static_cast<Clock*>(&tscClock) : &steadyClock);
+        traceThreadName("sim");
+    }
+    JobSystem pool(options.threads);             // Results do not depend on the thread count; only speed does.
+    if (pool.threadCount() > 1) jobs = &pool;
+    router.configure(sim.current.size());        // Before any producer; a restore reconfigures for its world.
+
+    if (options.restorePath) {
+        const int64_t restoreStart = timeSource->nowNs();
+        uint64_t unrestored = 0;
+        if (!restoreSnapshot(options.restorePath, sim, commandQueue, scheduler, router, unrestored)) {
+            cerr << "cannot restore snapshot " << options.restorePath << endl;
+            return 1;
+        }
+        cerr << "restored tick " << sim.tick << " in "
+             << static_cast<double>(timeSource->nowNs() - restoreStart) / 1e6 << " ms" << endl;
+        if (unrestored > 0) {                    // The run goes on, but it no longer matches the one checkpointed.
+            cerr << "warning: " << unrestored << " snapshot commands could not be restored" << endl;
+        }
+    }
+    std::vector<uint32_t> watch;                 // After any restore: bounded by the world being run.
+    if (!parseEntityList(options.watchList, sim.current.size(), watch)) {
+        cerr << "bad --watch list " << options.watchList << " (expected e.g. 0,7,100-199, entities below "
+             << sim.current.size() << ")" << endl;
+        return 2;
+    }
+    snapshotEvery = options.snapshotEvery;
+    snapshotPath = options.snapshotPath;
+    nextSnapshotTick = snapshotEvery > 0 ? (sim.tick / snapshotEvery + 1) * snapshotEvery : 0;
+
+    if (options.replayPath && !replay.open(options.replayPath)) {
+        cerr << "cannot load journal " << options.replayPath << endl;
+        return 1;
+    }
+    if (options.recordPath && !journal.open(options.recordPath)) {
+        cerr << "cannot open journal output " << options.recordPath << endl;
+        return 1;
+    }
+    if (options.hashLogPath) {
+        if (!hashLog.open(options.hashLogPath)) {
+            cerr << "cannot open hash log " << options.hashLogPath << endl;
+            return 1;
+        }
+        sim.hashEnabled = true;
+    }
+
+    int result = 0;
+    if (options.headless) {
+        uint64_t ticks = options.headlessTicks;
+        if (ticks == 0 && replay.isOpen()) {     // Reproduce the recorded run up to its end, from wherever we start:
+            const uint64_t endTick = replay.endTick(); // after --restore, sim.tick is the checkpoint's tick.
+            ticks = endTick > sim.tick ? endTick - sim.tick : 0;
+        }
+        result = runHeadless(sim, ticks);
+    } else {
+        if (!telemetry.open(options.telemetryPath)) {
+            cerr << "cannot open telemetry output " << options.telemetryPath << endl;
+            return 1;
+        }
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+        std::signal(SIGUSR1, requestSnapshot);
+        std::signal(SIGUSR2, requestTraceDump);
+        result = runRealTime(sim, options.framesPerSecond, watch);
+        telemetry.close();
+    }
+    journal.close(sim.tick);
+    hashLog.close();
+    if (tracePath && !traceDump(tracePath)) cerr << "cannot write trace " << tracePath << endl;
+    snapshots.wait();                            // Let an in-flight checkpoint finish before exiting.
+    return result;
+}
+
 // Fixed step accumulation: canonical solution for engines and simulators.
 // Logic: Accumulate real time, consume in fixed slices.
 // Result: Simulation is stable, deterministic, and frame-rate independent.
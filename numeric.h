@@ -0,0 +1,76 @@
+#ifndef NUMERIC_H
+#define NUMERIC_H
+
+#include <cmath>
+#include <cstdint>
+
+// Numeric type of the evolved state (position, velocity). Chosen at compile time:
+//   default            Real = double. Bit-exact across machines as long as every build rounds the same
+//                      way: SSE2/NEON, -ffp-contract=off (no FMA), no x87.
+//   SIM_FIXED_POINT    Real = Q32.32 fixed point in an int64_t (value * 2^32). Integer adds and shifts
+//                      only, so results cannot depend on the compiler, FPU mode or contraction settings.
+//                      Range +-2^31 with a resolution of 2^-32 (~2.3e-10). toReal saturates at the range;
+//                      past it, adds and scales wrap modulo 2^64, the same in the scalar and SIMD kernels.
+// Doubles stay at the edges: command values, seeding, telemetry and reports convert with toReal/fromReal.
+// Both types are 8 bytes, so array layout and the state hash (over raw bits) are the same shape in
+// either mode. The values differ, and so do the hashes: replicas in lockstep must share the mode.
+
+#ifdef SIM_FIXED_POINT
+
+using Real = int64_t;
+
+const int REAL_FRACTION_BITS = 32;
+const Real REAL_ONE = Real(1) << REAL_FRACTION_BITS;
+
+const double REAL_LIMIT = 0x1p63;                // 2^63 as a double: the first scaled value out of range.
+
+inline Real toReal(double value) {               // ldexp is exact; llround is round-half-away, everywhere.
+    const double scaled = std::ldexp(value, REAL_FRACTION_BITS);
+    if (scaled >= REAL_LIMIT) return INT64_MAX;  // Saturate: llround is undefined out of range.
+    if (scaled < -REAL_LIMIT) return INT64_MIN;
+    if (scaled != scaled) return 0;              // NaN.
+    return static_cast<Real>(std::llround(scaled));
+}
+
+inline double fromReal(Real value) {
+    return std::ldexp(static_cast<double>(value), -REAL_FRACTION_BITS);
+}
+
+// Arithmetic on Real is done in uint64_t: out of range it wraps modulo 2^64, like vpaddq and vpmuldq
+// in the SIMD lanes, instead of overflowing a signed type (undefined). Kernels stay bit-identical at
+// the edge of the range too. The cast back to int64_t is modular (guaranteed from C++20, and what
+// every supported compiler does before).
+inline Real addReal(Real a, Real b) {
+    return static_cast<Real>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+}
+
+// value * factor for a factor in [0, REAL_ONE], rounded down. Splits value into its signed high and
+// unsigned low 32 bits so both partial products fit in 64 bits: no 128-bit multiply, and the same
+// two 32x32 multiplies the SIMD kernels use (vpmuldq, vpmuludq).
+inline Real scaleReal(Real value, Real factor) {
+    const int64_t high = value >> REAL_FRACTION_BITS; // Arithmetic shift on every supported compiler.
+    const uint64_t low = static_cast<uint32_t>(value);
+    return static_cast<Real>(static_cast<uint64_t>(high) * static_cast<uint64_t>(factor)
+                             + ((low * static_cast<uint64_t>(factor)) >> REAL_FRACTION_BITS));
+}
+
+#else
+
+using Real = double;
+
+const Real REAL_ONE = 1.0;
+
+inline Real toReal(double value) { return value; }
+inline double fromReal(Real value) { return value; }
+inline Real addReal(Real a, Real b) { return a + b; }
+inline Real scaleReal(Real value, Real factor) { return value * factor; }
+
+#endif // SIM_FIXED_POINT
+
+// Longest tick the integrators take. The SIMD kernels feed the Q32.32 dt to vpmuldq as a signed 32-bit
+// operand, so it must stay below 2^31 (0.5 s). Checked in both modes, so a Config builds in either.
+constexpr double REAL_MAX_STEP_SECONDS = 0.5;
+
+static_assert(sizeof(Real) == 8, "state arrays and the hash assume 8-byte values");
+
+#endif // NUMERIC_H
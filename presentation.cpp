@@ -0,0 +1,120 @@
+#include "presentation.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "interest.h"
+#include "telemetry.h"
+#include "trace.h"
+
+namespace {
+const std::chrono::microseconds PRESENTER_IDLE_SLEEP(500); // Poll interval; well under one frame at any supported rate.
+}
+
+PresentationBuffer::PresentationBuffer(size_t entityCount) {
+    for (Slot& slot : slots_) {
+        slot.frame.entity.assign(entityCount, 0);
+        slot.frame.state = EntityStore(entityCount, SystemState{});
+    }
+}
+
+PresentationFrame* PresentationBuffer::beginWrite() {
+    const int front = front_.load();
+    const int back = front < 0 ? 0 : 1 - front;
+    if (slots_[back].pins.load() != 0) {         // A reader is still on the previous frame: skip rather than wait.
+        skipped_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    return &slots_[back].frame;
+}
+
+void PresentationBuffer::publish() {
+    const int front = front_.load();
+    const int back = front < 0 ? 0 : 1 - front;
+    slots_[back].frame.sequence = sequence_.load(std::memory_order_relaxed) + 1;
+    front_.store(back);                          // seq_cst: ordered before the next beginWrite()'s pin check.
+    sequence_.store(slots_[back].frame.sequence, std::memory_order_release);
+}
+
+const PresentationFrame* PresentationBuffer::acquire() {
+    for (;;) {
+        const int front = front_.load();
+        if (front < 0) return nullptr;
+        slots_[front].pins.fetch_add(1);
+        if (front_.load() == front) return &slots_[front].frame; // Still the front after pinning: safe to read.
+        slots_[front].pins.fetch_sub(1);         // Flipped in between; the writer may be on it next. Retry.
+    }
+}
+
+void PresentationBuffer::release(const PresentationFrame* frame) {
+    Slot& slot = frame == &slots_[0].frame ? slots_[0] : slots_[1];
+    slot.pins.fetch_sub(1, std::memory_order_release); // Reads of the frame happen before the writer reuses it.
+}
+
+Presenter::~Presenter() {
+    stop();
+}
+
+void Presenter::start(PresentationBuffer& buffer, TelemetrySink& telemetry, InterestRegistry& interest,
+                      const std::vector<uint32_t>& watch) {
+    stop();
+    buffer_ = &buffer;
+    telemetry_ = &telemetry;
+    interest_ = &interest;
+    watch_ = watch;
+    std::sort(watch_.begin(), watch_.end());
+    watch_.erase(std::unique(watch_.begin(), watch_.end()), watch_.end());
+    subscription_ = interest.subscribe(watch_);
+    running_.store(true, std::memory_order_release);
+    thread_ = std::thread(&Presenter::run, this);
+}
+
+void Presenter::stop() {
+    if (thread_.joinable()) {
+        running_.store(false, std::memory_order_release);
+        thread_.join();
+    }
+    if (interest_ && subscription_ >= 0) interest_->unsubscribe(subscription_);
+    subscription_ = -1;
+}
+
+void Presenter::run() {
+    if (traceEnabled()) traceThreadName("present");
+    uint64_t seen = 0;
+    for (;;) {
+        bool stopping = !running_.load(std::memory_order_acquire); // Sample first so the final frame is not lost.
+        if (presentLatest(seen)) continue;
+        if (stopping) break;
+        std::this_thread::sleep_for(PRESENTER_IDLE_SLEEP);
+    }
+}
+
+bool Presenter::presentLatest(uint64_t& seen) {
+    if (buffer_->published() <= seen) return false;
+    const PresentationFrame* frame = buffer_->acquire();
+    if (!frame) return false;
+    if (frame->sequence <= seen) {               // publish() flips front_ before bumping sequence_: already presented.
+        buffer_->release(frame);
+        return false;
+    }
+    TRACE_SCOPE("present");
+    seen = frame->sequence;                      // Only moves forward.
+
+    size_t w = 0;                                // Both lists are sorted: one merge pass.
+    for (size_t i = 0; i < frame->count && w < watch_.size(); ++i) {
+        while (w < watch_.size() && watch_[w] < frame->entity[i]) ++w; // Not in this frame yet (just subscribed).
+        if (w == watch_.size() || watch_[w] != frame->entity[i]) continue; // Another consumer's entity.
+        TelemetryRecord record{};
+        record.timeNs = frame->timeNs;
+        record.dtNs = frame->dtNs;
+        record.entity = frame->entity[i];
+        record.valid = frame->state.valid[i];
+        record.position = fromReal(frame->state.position[i]);
+        record.velocity = fromReal(frame->state.velocity[i]);
+        telemetry_->publish(record);             // Copy into the ring; the writer thread does the I/O.
+        ++w;
+    }
+    buffer_->release(frame);
+    presented_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
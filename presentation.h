@@ -0,0 +1,98 @@
+#ifndef PRESENTATION_H
+#define PRESENTATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "simulation.h"
+
+class InterestRegistry;
+class TelemetrySink;
+
+// Hand-off of interpolated frames from the sim thread to a render/output thread, without locks.
+//
+// Two preallocated frames: the sim thread blends into the back one and publishes it with one atomic
+// store; readers pin the published (front) frame while they read it. Before writing the back frame
+// the sim thread checks its pin count. If a slow reader still holds it from the frame before, the new
+// frame is skipped and counted. The sim thread never waits for a reader, and a reader never sees a
+// frame that is being written.
+//
+// Pin and publish are both seq_cst: either the reader's pin is visible to the writer's check, or the
+// writer's publish is visible to the reader's re-check and the reader retries on the new front.
+// Readers always get the latest frame. A reader slower than the frame rate misses frames; it does
+// not queue them up.
+
+struct PresentationFrame {                       // Observed entities only (interest.h), packed in entity order.
+    size_t count = 0;
+    std::vector<uint32_t> entity;                // [0, count): sorted entity indices.
+    EntityStore state;                           // [0, count): interpolated state of entity[i]; never fed back.
+    int64_t timeNs = 0;                          // Frame timestamp from the run's Clock.
+    int64_t dtNs = 0;                            // Measured (unclamped) frame delta.
+    uint64_t tick = 0;                           // sim.tick the frame was blended towards.
+    uint64_t sequence = 0;                       // Publish count; readers use it to spot new frames.
+};
+
+class PresentationBuffer {
+public:
+    explicit PresentationBuffer(size_t entityCount); // Sizes both frames for the whole world; nothing allocates after this.
+
+    PresentationBuffer(const PresentationBuffer&) = delete;
+    PresentationBuffer& operator=(const PresentationBuffer&) = delete;
+
+    // Sim thread. Returns the back frame to fill, or nullptr if a reader still holds it (frame skipped).
+    PresentationFrame* beginWrite();
+    void publish();                              // Sim thread, after beginWrite() returned a frame: it becomes the front.
+
+    const PresentationFrame* acquire();          // Any reader thread. Pins the front frame; nullptr before the first publish.
+    void release(const PresentationFrame* frame); // Unpins what acquire() returned.
+
+    uint64_t published() const { return sequence_.load(std::memory_order_acquire); }
+    uint64_t skipped() const { return skipped_.load(std::memory_order_relaxed); }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        PresentationFrame frame;
+        std::atomic<uint32_t> pins{0};           // Readers currently holding this frame.
+    };
+
+    Slot slots_[2];
+    std::atomic<int> front_{-1};                 // Published slot; -1 until the first publish.
+    std::atomic<uint64_t> sequence_{0};
+    std::atomic<uint64_t> skipped_{0};
+};
+
+// Output thread for published frames: a watch-list consumer. It registers its entities with the
+// InterestRegistry and turns each new frame into one telemetry record per watched entity, off the
+// sim thread. A renderer would register its viewport and read the same buffer the same way.
+class Presenter {
+public:
+    Presenter() = default;
+    ~Presenter();
+
+    Presenter(const Presenter&) = delete;
+    Presenter& operator=(const Presenter&) = delete;
+
+    void start(PresentationBuffer& buffer, TelemetrySink& telemetry, InterestRegistry& interest,
+               const std::vector<uint32_t>& watch);
+    void stop();                                 // Presents the last published frame, joins, unsubscribes.
+
+    uint64_t presented() const { return presented_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+    bool presentLatest(uint64_t& seen);          // False if nothing new was published.
+
+    PresentationBuffer* buffer_ = nullptr;
+    TelemetrySink* telemetry_ = nullptr;
+    InterestRegistry* interest_ = nullptr;
+    int subscription_ = -1;
+    std::vector<uint32_t> watch_;                // Sorted, unique.
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> presented_{0};
+};
+
+#endif // PRESENTATION_H
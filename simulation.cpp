@@ -0,0 +1,362 @@
+#include "simulation.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "integrator.h"
+#include "job_system.h"
+#include "state_hash.h"
+#include "trace.h"
+
+EntityStore::EntityStore(size_t count, const SystemState& initial)
+    : position(count, toReal(initial.position)),
+      velocity(count, toReal(initial.velocity)),
+      valid(count, initial.valid ? 1 : 0) {
+}
+
+SystemState EntityStore::get(size_t index) const {
+    return SystemState{fromReal(position[index]), fromReal(velocity[index]), valid[index] != 0};
+}
+
+void EntityStore::set(size_t index, const SystemState& state) {
+    position[index] = toReal(state.position);
+    velocity[index] = toReal(state.velocity);
+    valid[index] = state.valid ? 1 : 0;
+}
+
+void updateSystem(EntityStore& store, double dtSeconds) {
+    TRACE_SCOPE("updateSystem");
+    integrate(store.position.data(), store.velocity.data(), store.valid.data(), store.size(), dtSeconds); // SIMD kernel picked at runtime.
+}
+
+uint64_t hashState(const EntityStore& store) {
+    uint64_t hash = HASH_SEED;
+    const size_t count = store.size();
+    for (size_t begin = 0, block = 0; begin < count; begin += ENTITY_BLOCK_SIZE, ++block) {
+        size_t n = count - begin < ENTITY_BLOCK_SIZE ? count - begin : ENTITY_BLOCK_SIZE;
+        hash = hashCombine(hash, hashBlock(store.position.data() + begin, store.velocity.data() + begin,
+                                           store.valid.data() + begin, n), block);
+    }
+    return hash;
+}
+
+void applyCommand(EntityStore& store, const Command& cmd) {
+    if (cmd.entity == ALL_ENTITIES) applyCommandRange(store, cmd, 0, store.size());
+    else if (cmd.entity < store.size()) applyCommandRange(store, cmd, cmd.entity, cmd.entity + 1);
+}
+
+void applyCommandRange(EntityStore& store, const Command& cmd, size_t begin, size_t end) {
+    Real* velocity = store.velocity.data();
+    const uint8_t* valid = store.valid.data();
+    const Real value = toReal(cmd.value);        // Converted once per command, not per entity.
+
+    switch(cmd.type) {                           // Switch once per command, not once per entity.
+    case CommandType::Accelerate:                // Adjust velocity, not position. Physics integration happens in updateSystem().
+        for (size_t i = begin; i < end; ++i) {
+            if (valid[i]) velocity[i] = addReal(velocity[i], value); // Invalid systems do not accept commands.
+        }
+        break;
+    case CommandType::Stop:                      // Immediate velocity cancellation. Deterministic in fixed-step context.
+        for (size_t i = begin; i < end; ++i) {
+            if (valid[i]) velocity[i] = 0;
+        }
+        break;
+    }
+}
+
+namespace {
+
+struct InterpolateContext {                      // Read-only description of one blend for the block jobs.
+    const EntityStore* prev;
+    const EntityStore* curr;
+    EntityStore* out;
+    double alpha;
+};
+
+void interpolateBlocks(void* context, size_t firstBlock, size_t lastBlock) {
+    TRACE_SCOPE("interpolate");
+    const InterpolateContext& blend = *static_cast<const InterpolateContext*>(context);
+    const size_t count = blend.curr->size();
+    for (size_t block = firstBlock; block < lastBlock; ++block) {
+        size_t begin = block * ENTITY_BLOCK_SIZE;
+        size_t n = count - begin < ENTITY_BLOCK_SIZE ? count - begin : ENTITY_BLOCK_SIZE;
+        interpolate(blend.prev->position.data() + begin, blend.prev->velocity.data() + begin,
+                    blend.curr->position.data() + begin, blend.curr->velocity.data() + begin,
+                    blend.out->position.data() + begin, blend.out->velocity.data() + begin, n, blend.alpha);
+        std::memcpy(blend.out->valid.data() + begin, blend.curr->valid.data() + begin, n); // Discrete: newest value.
+    }
+}
+
+struct SubsetContext {                           // Read-only description of one observed-set blend.
+    const EntityStore* prev;
+    const EntityStore* curr;
+    const uint32_t* entities;                    // Sorted, unique.
+    size_t count;
+    EntityStore* out;                            // Packed: out[i] is entities[i].
+    double alpha;
+};
+
+const size_t INTERPOLATE_RUN_MIN = 16;           // Consecutive entities worth a kernel call; shorter runs go scalar.
+
+void interpolateSubsetChunks(void* context, size_t firstChunk, size_t lastChunk) {
+    TRACE_SCOPE("interpolate");
+    const SubsetContext& blend = *static_cast<const SubsetContext*>(context);
+    const EntityStore& prev = *blend.prev;
+    const EntityStore& curr = *blend.curr;
+    EntityStore& out = *blend.out;
+    const Real weight = toReal(blend.alpha);
+    const Real beta = REAL_ONE - weight;
+    const size_t end = lastChunk * ENTITY_BLOCK_SIZE < blend.count ? lastChunk * ENTITY_BLOCK_SIZE : blend.count;
+    for (size_t i = firstChunk * ENTITY_BLOCK_SIZE; i < end;) {
+        const size_t first = blend.entities[i];
+        size_t run = 1;                          // Viewports and track ranges come as runs of adjacent indices.
+        while (i + run < end && blend.entities[i + run] == first + run) ++run;
+        if (run >= INTERPOLATE_RUN_MIN) {
+            interpolate(prev.position.data() + first, prev.velocity.data() + first,
+                        curr.position.data() + first, curr.velocity.data() + first,
+                        out.position.data() + i, out.velocity.data() + i, run, blend.alpha);
+            std::memcpy(out.valid.data() + i, curr.valid.data() + first, run);
+        } else {
+            for (size_t k = 0; k < run; ++k) {   // Same operations as the kernels: results do not depend on the path.
+                out.position[i + k] = addReal(scaleReal(prev.position[first + k], beta), scaleReal(curr.position[first + k], weight));
+                out.velocity[i + k] = addReal(scaleReal(prev.velocity[first + k], beta), scaleReal(curr.velocity[first + k], weight));
+                out.valid[i + k] = curr.valid[first + k];
+            }
+        }
+        i += run;
+    }
+}
+
+} // namespace
+
+void interpolateSubset(const EntityStore& prev, const EntityStore& curr, double alpha,
+                       const uint32_t* entities, size_t count, EntityStore& out, JobSystem* jobs) {
+    if (out.size() < count) {                    // Only allocates if out was not sized for the world.
+        out.position.resize(count);
+        out.velocity.resize(count);
+        out.valid.resize(count);
+    }
+    SubsetContext blend{&prev, &curr, entities, count, &out, alpha};
+    const size_t chunks = (count + ENTITY_BLOCK_SIZE - 1) / ENTITY_BLOCK_SIZE;
+    if (jobs && chunks > 1) jobs->parallelFor(chunks, 1, &interpolateSubsetChunks, &blend);
+    else interpolateSubsetChunks(&blend, 0, chunks);
+}
+
+void interpolateState(const EntityStore& prev, const EntityStore& curr, double alpha, EntityStore& out,
+                      JobSystem* jobs) {
+    const size_t count = curr.size();
+    if (out.size() != count) {                   // Only allocates on first use or when the world is resized.
+        out.position.resize(count);
+        out.velocity.resize(count);
+        out.valid.resize(count);
+    }
+    InterpolateContext blend{&prev, &curr, &out, alpha}; // Interpolating function for display layer.
+    const size_t blocks = (count + ENTITY_BLOCK_SIZE - 1) / ENTITY_BLOCK_SIZE;
+    if (jobs) jobs->parallelFor(blocks, 1, &interpolateBlocks, &blend);
+    else interpolateBlocks(&blend, 0, blocks);
+}
+
+namespace {
+
+struct StepContext {                             // Shared, read-only description of one step for the block jobs.
+    SimulationState* sim;
+    const Command* broadcast;
+    size_t broadcastCount;
+    const Command* targeted;                     // Sorted by entity.
+    size_t targetedCount;
+    bool deferrable;                             // Fast-forward: blocks without commands may be left behind.
+};
+
+// Redoes one commanded entity of an out-of-place block: its state from last tick, its commands in
+// order, then the same integration, one entity. The kernel's hash term for the stale result is swapped
+// for the new one; the sums are modular, so the block hash ends up exactly as if it had been right.
+void patchEntity(const EntityStore& from, EntityStore& to, size_t entity, const Command* first, const Command* last,
+                 size_t blockBegin, double dtSeconds, HashAccumulator* hash) {
+    const uint32_t local = static_cast<uint32_t>(entity - blockBegin);
+    if (hash) {
+        HashAccumulator stale;
+        hashEntity(to.position[entity], to.velocity[entity], to.valid[entity], local, stale);
+        hash->position -= stale.position;
+        hash->velocity -= stale.velocity;
+        hash->valid -= stale.valid;
+    }
+    to.position[entity] = from.position[entity];
+    to.velocity[entity] = from.velocity[entity];
+    to.valid[entity] = from.valid[entity];
+    for (const Command* command = first; command != last; ++command) {
+        applyCommandRange(to, *command, entity, entity + 1);
+    }
+    integrateScalar(&to.position[entity], &to.velocity[entity], &to.valid[entity],
+                    &to.position[entity], &to.velocity[entity], &to.valid[entity], 1, dtSeconds);
+    if (hash) hashEntity(to.position[entity], to.velocity[entity], to.valid[entity], local, *hash);
+}
+
+// True if every entity in [begin, begin + n) is settled: invalid in both stores, with identical bits.
+bool settledChunk(const EntityStore& from, const EntityStore& to, size_t begin, size_t n) {
+    uint8_t anyValid = 0;
+    for (size_t i = begin; i < begin + n; ++i) anyValid |= from.valid[i] | to.valid[i]; // No early exit: vectorizes.
+    return anyValid == 0 &&
+           std::memcmp(&from.position[begin], &to.position[begin], n * sizeof(Real)) == 0 && // Bits, not ==: -0.0, NaN.
+           std::memcmp(&from.velocity[begin], &to.velocity[begin], n * sizeof(Real)) == 0;
+}
+
+// Spans of the block's live chunks and the hash terms of the settled ones.
+void rebuildActiveBlock(const EntityStore& from, const EntityStore& to, size_t begin, size_t n, ActiveBlock& active) {
+    active.spanCount = 0;
+    active.settled = HashAccumulator();
+    bool open = false;                           // The previous chunk was live: extend its span.
+    for (size_t chunk = 0; chunk < n; chunk += ACTIVE_CHUNK_ENTITIES) {
+        const size_t chunkEnd = n - chunk < ACTIVE_CHUNK_ENTITIES ? n : chunk + ACTIVE_CHUNK_ENTITIES;
+        if (!settledChunk(from, to, begin + chunk, chunkEnd - chunk)) {
+            if (!open) active.spanBegin[active.spanCount++] = static_cast<uint16_t>(chunk);
+            active.spanEnd[active.spanCount - 1] = static_cast<uint16_t>(chunkEnd);
+            open = true;
+            continue;
+        }
+        for (size_t i = chunk; i < chunkEnd; ++i) {
+            hashEntity(from.position[begin + i], from.velocity[begin + i], from.valid[begin + i],
+                       static_cast<uint32_t>(i), active.settled);
+        }
+        open = false;
+    }
+    active.built = true;
+}
+
+// One tick of one block: from holds the block at tick, to receives tick + 1.
+void stepBlock(SimulationState& sim, const EntityStore& from, EntityStore& to, size_t block, uint64_t tick,
+               const Command* broadcast, size_t broadcastCount, const Command* slice, const Command* sliceEnd) {
+    const size_t begin = block * ENTITY_BLOCK_SIZE;
+    const size_t n = from.size() - begin < ENTITY_BLOCK_SIZE ? from.size() - begin : ENTITY_BLOCK_SIZE;
+    ActiveBlock& active = sim.activeBlocks[block];
+    if (!active.built || (tick + block) % ACTIVE_REBUILD_TICKS == 0) { // Staggered: a few blocks per tick.
+        rebuildActiveBlock(from, to, begin, n, active);
+    }
+
+    HashAccumulator acc = active.settled;        // Skipped entities contribute their (unchanging) terms.
+    HashAccumulator* hash = sim.hashEnabled ? &acc : nullptr; // Hash accumulated on values still in registers.
+    if (broadcastCount > 0) {
+        // Every valid entity is commanded: bring each span over (it stays in cache), then the
+        // in-place sequence. Memory traffic is the same as the out-of-place kernel: one read, one write.
+        for (size_t span = 0; span < active.spanCount; ++span) {
+            const size_t first = begin + active.spanBegin[span];
+            const size_t last = begin + active.spanEnd[span];
+            std::memcpy(to.position.data() + first, from.position.data() + first, (last - first) * sizeof(Real));
+            std::memcpy(to.velocity.data() + first, from.velocity.data() + first, (last - first) * sizeof(Real));
+            std::memcpy(to.valid.data() + first, from.valid.data() + first, last - first);
+            for (size_t i = 0; i < broadcastCount; ++i) {
+                applyCommandRange(to, broadcast[i], first, last); // Same FIFO order in every block.
+            }
+        }
+        for (const Command* command = slice; command != sliceEnd; ++command) { // Settled targets ignore it.
+            applyCommandRange(to, *command, command->entity, command->entity + 1);
+        }
+        for (size_t span = 0; span < active.spanCount; ++span) {
+            const size_t first = begin + active.spanBegin[span];
+            integrate(to.position.data() + first, to.velocity.data() + first, to.valid.data() + first,
+                      active.spanEnd[span] - active.spanBegin[span], sim.stepSeconds, hash, active.spanBegin[span]);
+        }
+    } else {
+        for (size_t span = 0; span < active.spanCount; ++span) { // Source of truth; fixed stepSeconds slices.
+            const size_t first = begin + active.spanBegin[span];
+            integrate(from.position.data() + first, from.velocity.data() + first, from.valid.data() + first,
+                      to.position.data() + first, to.velocity.data() + first, to.valid.data() + first,
+                      active.spanEnd[span] - active.spanBegin[span], sim.stepSeconds, hash, active.spanBegin[span]);
+        }
+        for (const Command* command = slice; command != sliceEnd;) { // Commanded entities: redo from last tick.
+            const Command* run = command;
+            while (command != sliceEnd && command->entity == run->entity) ++command;
+            patchEntity(from, to, run->entity, run, command, begin, sim.stepSeconds, hash);
+        }
+    }
+    if (hash) sim.blockHashes[block] = finishBlockHash(acc, n);
+}
+
+// Replays the ticks a deferred block missed, command-free, with the same kernels: bit-identical to
+// having stepped it every tick. The block stays in cache for the whole replay.
+void catchUpBlock(SimulationState& sim, size_t block) {
+    for (uint64_t tick = sim.blockTick[block]; tick < sim.tick; ++tick) {
+        const bool inCurrent = (sim.tick - tick) % 2 == 0; // Where this tick's state sits after the swaps since.
+        stepBlock(sim, inCurrent ? sim.current : sim.previous, inCurrent ? sim.previous : sim.current, block, tick,
+                  nullptr, 0, nullptr, nullptr);
+    }
+    sim.blockTick[block] = sim.tick;
+}
+
+void catchUpBlocks(void* context, size_t firstBlock, size_t lastBlock) {
+    TRACE_SCOPE("catchUp");
+    SimulationState& sim = *static_cast<SimulationState*>(context);
+    for (size_t block = firstBlock; block < lastBlock; ++block) catchUpBlock(sim, block);
+}
+
+void stepBlocks(void* context, size_t firstBlock, size_t lastBlock) {
+    TRACE_SCOPE("updateSystem");                 // One event per job (block range), on the thread that ran it.
+    const StepContext& step = *static_cast<const StepContext*>(context);
+    SimulationState& sim = *step.sim;
+    const size_t count = sim.current.size();
+    const Command* targetedEnd = step.targeted + step.targetedCount;
+
+    for (size_t block = firstBlock; block < lastBlock; ++block) {
+        size_t begin = block * ENTITY_BLOCK_SIZE;
+        size_t n = count - begin < ENTITY_BLOCK_SIZE ? count - begin : ENTITY_BLOCK_SIZE;
+        const Command* slice = std::lower_bound(step.targeted, targetedEnd, begin,
+                                                [](const Command& c, size_t entity) { return c.entity < entity; });
+        const Command* sliceEnd = slice;         // This block's targeted commands.
+        while (sliceEnd != targetedEnd && sliceEnd->entity < begin + n) ++sliceEnd;
+
+        if (step.deferrable && slice == sliceEnd && (sim.tick + block) % FAST_FORWARD_MAX_LAG != 0) continue;
+        catchUpBlock(sim, block);                // No-op unless the block was deferred.
+        stepBlock(sim, sim.current, sim.previous, block, sim.tick, step.broadcast, step.broadcastCount, slice, sliceEnd);
+        sim.blockTick[block] = sim.tick + 1;
+    }
+}
+
+} // namespace
+
+void stepSimulation(SimulationState& sim, const Command* broadcast, size_t broadcastCount,
+                    const Command* targeted, size_t targetedCount, JobSystem* jobs) {
+    const size_t blocks = (sim.current.size() + ENTITY_BLOCK_SIZE - 1) / ENTITY_BLOCK_SIZE;
+    if (sim.previous.size() != sim.current.size()) { // Only after a resize/restore.
+        sim.previous = sim.current;
+        sim.activeBlocks.clear();
+        sim.blockTick.clear();
+    }
+    if (sim.hashEnabled && sim.blockHashes.size() != blocks) sim.blockHashes.resize(blocks);
+    if (sim.activeBlocks.size() != blocks) sim.activeBlocks.assign(blocks, ActiveBlock()); // built = false: rebuilt on first use.
+    if (sim.blockTick.size() != blocks) sim.blockTick.assign(blocks, sim.tick);
+
+    // The hash covers every entity every tick, and a broadcast touches every block: neither can defer.
+    const bool deferrable = sim.fastForward && !sim.hashEnabled && broadcastCount == 0;
+    StepContext step{&sim, broadcast, broadcastCount, targeted, targetedCount, deferrable};
+    if (jobs) {
+        jobs->parallelFor(blocks, 1, &stepBlocks, &step); // Returns after the barrier: every block is done.
+    } else {
+        stepBlocks(&step, 0, blocks);
+    }
+    std::swap(sim.current, sim.previous);        // Ping-pong: pointer swaps, no copy of the world.
+
+    if (sim.hashEnabled) {
+        uint64_t hash = HASH_SEED;
+        for (size_t block = 0; block < blocks; ++block) {
+            hash = hashCombine(hash, sim.blockHashes[block], block); // Fixed order: independent of thread count.
+        }
+        sim.stateHash = hash;
+    }
+    ++sim.tick;
+}
+
+void syncState(SimulationState& sim, JobSystem* jobs) {
+    const size_t blocks = sim.blockTick.size();  // Empty before the first step: nothing is behind.
+    if (jobs) jobs->parallelFor(blocks, 1, &catchUpBlocks, &sim);
+    else catchUpBlocks(&sim, 0, blocks);
+}
+
+void syncEntities(SimulationState& sim, const uint32_t* entities, size_t count) {
+    size_t lastBlock = sim.blockTick.size();     // None yet.
+    for (size_t i = 0; i < count; ++i) {
+        const size_t block = entities[i] / ENTITY_BLOCK_SIZE;
+        if (block == lastBlock || block >= sim.blockTick.size()) continue; // Sorted: one check per block.
+        catchUpBlock(sim, block);
+        lastBlock = block;
+    }
+}
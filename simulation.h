@@ -0,0 +1,148 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "command_queue.h"
+#include "numeric.h"
+#include "state_hash.h"
+
+// Simulation domain: tuning constants, commands and the entity state evolved by the fixed-step engine.
+// Everything in here is deterministic and free of wall-clock time; SimulationEngine (engine.h) owns the loop.
+
+// The engine defaults (DefaultEngineConfig in engine.h); a SimulationEngine instance takes its own from its Config.
+constexpr double MAX_DT_SECONDS = 0.05;          // Typical real-time systems use 10-50ms. (dt clamping)
+constexpr double FIXED_DT_SECONDS = 0.01;        // Simulation tick. Deterministic, predictable, testable. (fixed step accumulation)
+constexpr int MAX_SIMULATION_STEPS_PER_FRAME = 5; // Hard safety cap. Prevents infinite catch-up if system lags. (load control & stability)
+// Without this: lag -> more steps -> more CPU -> more lag -> death spiral.
+// With this: simulation is bounded, CPU is capped, system degrades gracefully.
+
+const size_t MAX_COMMAND_QUEUE_SIZE = 32;        // Hard upper bound for input pressure. Prevents unbounded memory growth.
+const int MAX_COMMANDS_PER_STEP = 4;             // Limit applied (post-coalescing) broadcast commands per step to prevent physics starvation.
+// Targeted commands have no cap of their own: the partition rings and wheels bound them per step
+// (MAX_TARGETED_COMMANDS_PER_STEP), and coalescing leaves at most two per entity.
+
+const size_t ENTITY_COUNT = 65536;               // Number of simulated tracks. Sized for tens of thousands per tick.
+const size_t ENTITY_BLOCK_SIZE = HASH_BLOCK_ENTITIES; // Fixed unit of work: parallel jobs and hash folding both cut here.
+
+enum class CommandType {                         // Represents "intent" coming from UI, network or sensors.
+    Accelerate, Stop
+};
+
+const uint32_t ALL_ENTITIES = 0xFFFFFFFFu;       // Command target meaning "every entity" (broadcast).
+
+struct Command {                                 // Small, copyable instruction. Safe to queue or batch.
+    CommandType type;
+    double value;                                // Parameter for the command (acceleration magnitude).
+    uint64_t targetTick = 0;                     // Step (sim.tick) to apply it at; 0 or past = the next step.
+    uint32_t entity = ALL_ENTITIES;              // Target entity index, or ALL_ENTITIES.
+};
+
+using CommandQueue = MpscRingBuffer<Command, MAX_COMMAND_QUEUE_SIZE>; // Ingestion queue: any thread in, sim thread out.
+
+struct SystemState {                             // Single-entity view in doubles; used for seeding and presentation, not for the hot loop.
+    double position;                             // Continuous state variable; example of a physical property.
+    double velocity;                             // Rate of change of position; essential for integration.
+    bool valid;                                  // Data validity flag; simulation stops evolving when false.
+};
+
+// Structure-of-arrays store: each field lives in its own contiguous array so batch passes
+// stream through exactly the bytes they need (position/velocity for integration, valid as a mask).
+// Entity i is the tuple (position[i], velocity[i], valid[i]); the index is the entity's identity.
+struct EntityStore {                             // Real: double, or Q32.32 under SIM_FIXED_POINT (numeric.h).
+    std::vector<Real> position;
+    std::vector<Real> velocity;
+    std::vector<uint8_t> valid;                  // uint8_t instead of vector<bool>: addressable, no bit-proxy, vector friendly.
+
+    EntityStore() = default;
+    EntityStore(size_t count, const SystemState& initial);
+
+    size_t size() const { return position.size(); }
+    SystemState get(size_t index) const;
+    void set(size_t index, const SystemState& state);
+};
+
+// Active set: which entities of a block the step still has to touch. An entity that is invalid in both
+// buffers is settled. Nothing changes it any more: the kernels leave invalid entities as they are and
+// commands skip them. A settled entity is identical in current and previous, so the ping-pong step can
+// leave it out altogether. Blocks are cut into chunks of ACTIVE_CHUNK_ENTITIES; a chunk whose entities
+// are all settled is skipped, and its constant hash terms are added instead. Skipping whole chunks
+// keeps the scan branch-light and the kernel calls long. A kernel call for a few scattered live
+// entities would cost more than streaming the dead ones between them.
+// Span lists are rebuilt every ACTIVE_REBUILD_TICKS ticks, staggered across blocks. In between they can
+// only be stale in the safe direction (still covering chunks that have settled since), so a chunk
+// leaves the hot loop at most that many ticks after its last entity died.
+const size_t ACTIVE_CHUNK_ENTITIES = 64;         // 512 bytes of each state array: 8 cache lines.
+const uint64_t ACTIVE_REBUILD_TICKS = 16;        // Rebuild period per block.
+const size_t ACTIVE_MAX_SPANS = (ENTITY_BLOCK_SIZE / ACTIVE_CHUNK_ENTITIES + 1) / 2; // Live and dead chunks alternating.
+
+struct ActiveBlock {
+    bool built = false;                          // False: spans not computed yet; the next step builds them.
+    uint16_t spanCount = 0;
+    uint16_t spanBegin[ACTIVE_MAX_SPANS] = {};   // Block-local [begin, end) of each run of live chunks, ascending.
+    uint16_t spanEnd[ACTIVE_MAX_SPANS] = {};
+    HashAccumulator settled;                     // Hash terms of the skipped (settled) chunks.
+};
+
+// Fast-forward: with no commands, a block's next states follow from its current one alone. A step with
+// fastForward set leaves such blocks where they are and records how far behind they are (blockTick).
+// A deferred block is replayed, one kernel pass per missed tick, as soon as anything needs it: a
+// command for it, a broadcast, the hash, a reader (syncState/syncEntities), or its lag limit.
+// Replaying the same operations makes the result bit-identical to stepping every tick. A zero crossing
+// is computed the same way. A closed form (p + k*v*dt) would round differently. What fast-forward saves
+// is memory traffic: the replay runs while the block sits in cache, instead of streaming the whole
+// world from DRAM once per tick. Blocks are forced to catch up every FAST_FORWARD_MAX_LAG ticks,
+// staggered, so a late command never triggers an unbounded replay.
+const uint64_t FAST_FORWARD_MAX_LAG = 256;       // Ticks. Caps one block's replay at a few hundred microseconds.
+
+// Everything the fixed-step engine evolves. Identical input (initial state + per-tick commands)
+// gives identical output whether steps are paced by the wall clock or run back-to-back.
+struct SimulationState {
+    // Ping-pong pair: each step reads current, writes previous, then swaps them (std::vector swap, O(1)).
+    EntityStore current;                         // Source of truth.
+    EntityStore previous;                        // State one tick earlier; feeds presentation interpolation.
+    double timeAccumulator = 0.0;                // Buffer for unprocessed real time. Prevents time loss and instability.
+    uint64_t tick = 0;                           // Fixed steps completed since start.
+    double stepSeconds = FIXED_DT_SECONDS;       // Length of one tick. SimulationEngine sets it from its Config.
+    bool hashEnabled = false;                    // Hash the state after every step (divergence detection).
+    uint64_t stateHash = 0;                      // Hash of current after the last step; valid when hashEnabled.
+    std::vector<uint64_t> blockHashes;           // Per-block results, folded in block order after the barrier.
+    bool fastForward = false;                    // Defer command-free blocks (see above). Has no effect while hashEnabled.
+    std::vector<ActiveBlock> activeBlocks;       // Per block. Clear it after editing current/previous outside a step.
+    std::vector<uint64_t> blockTick;             // Per block: tick its stores hold. Below tick = deferred. Clear as above.
+
+    explicit SimulationState(const EntityStore& initial) : current(initial), previous(initial) {}
+};
+
+class JobSystem;
+
+// One fixed sim.stepSeconds step. With a JobSystem, entity blocks are stepped in parallel; every block
+// runs the same apply/integrate sequence on its own entities, so results are identical for any thread count.
+// The step writes the new state over previous and swaps the pair: no per-step copy of the world.
+// Per entity, broadcast commands apply first (in order), then the targeted ones. targeted must be sorted by
+// entity (stable: FIFO per entity); each block applies only its own slice of it. Order is FIFO within each
+// stream, not across them: a targeted Stop that arrived before a broadcast Accelerate still applies after
+// it. The two streams come through separate queues with no shared arrival sequence, on purpose (see
+// CommandRouter).
+void stepSimulation(SimulationState& sim, const Command* broadcast, size_t broadcastCount,
+                    const Command* targeted, size_t targetedCount, JobSystem* jobs = nullptr);
+
+// With fastForward, current/previous are only up to date for blocks that were synced. Read them after
+// syncState() (everything: final report, snapshot) or syncEntities() (a sorted subset: presentation).
+void syncState(SimulationState& sim, JobSystem* jobs = nullptr);
+void syncEntities(SimulationState& sim, const uint32_t* entities, size_t count);
+
+void updateSystem(EntityStore& store, double dtSeconds);                // Integrate all entities by one step.
+uint64_t hashState(const EntityStore& store);                           // Same value stepSimulation() reports in stateHash.
+void applyCommand(EntityStore& store, const Command& cmd);              // Apply one command to its target (or every) valid entity.
+void applyCommandRange(EntityStore& store, const Command& cmd,
+                       size_t begin, size_t end);                       // Apply to entities [begin, end), ignoring cmd.entity.
+void interpolateState(const EntityStore& prev, const EntityStore& curr, double alpha,
+                      EntityStore& out, JobSystem* jobs = nullptr);     // SIMD blend into out (resized as needed), block-parallel on jobs.
+void interpolateSubset(const EntityStore& prev, const EntityStore& curr, double alpha,
+                       const uint32_t* entities, size_t count,
+                       EntityStore& out, JobSystem* jobs = nullptr);    // Blend only entities (sorted) into out[0, count), packed.
+
+#endif // SIMULATION_H
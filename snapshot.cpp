@@ -0,0 +1,277 @@
+#include "snapshot.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+
+const uint64_t SECTION_ALIGNMENT = 64;           // Cache-line aligned sections: mmap'd arrays load cleanly.
+const size_t MAX_PENDING_COMMANDS = MAX_COMMAND_QUEUE_SIZE + COMMAND_PARTITIONS * PARTITION_QUEUE_CAPACITY;
+const size_t MAX_WAITING_COMMANDS = MAX_SCHEDULED_COMMANDS + COMMAND_PARTITIONS * PARTITION_SCHEDULED_COMMANDS;
+
+struct SnapshotLayout {
+    uint64_t offset[SNAPSHOT_SECTIONS];
+    uint64_t size[SNAPSHOT_SECTIONS];
+    uint64_t fileSize;
+};
+
+uint64_t alignUp(uint64_t value) {
+    return (value + SECTION_ALIGNMENT - 1) & ~(SECTION_ALIGNMENT - 1);
+}
+
+SnapshotLayout layoutFor(uint64_t entityCount, uint64_t pendingCount, uint64_t scheduledCount) {
+    SnapshotLayout layout;
+    const uint64_t sizes[SNAPSHOT_SECTIONS] = {
+        entityCount * sizeof(Real), entityCount * sizeof(Real), entityCount, // current
+        entityCount * sizeof(Real), entityCount * sizeof(Real), entityCount, // previous
+        pendingCount * sizeof(SnapshotCommand), scheduledCount * sizeof(SnapshotCommand)
+    };
+    uint64_t offset = alignUp(sizeof(SnapshotHeader));
+    for (int i = 0; i < SNAPSHOT_SECTIONS; ++i) {
+        layout.offset[i] = offset;
+        layout.size[i] = sizes[i];
+        offset = alignUp(offset + sizes[i]);
+    }
+    layout.fileSize = offset;
+    return layout;
+}
+
+// Section checksum: four independent multiply-xor lanes over 8-byte words, so it runs near memory
+// speed. Catches bit rot, truncation and torn writes; not meant to resist tampering.
+uint64_t checksum(const void* data, uint64_t size) {
+    const uint64_t MULTIPLIER = 0x9E3779B97F4A7C15ULL;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t lane[4] = {size, 0x243F6A8885A308D3ULL, 0x13198A2E03707344ULL, 0xA4093822299F31D0ULL};
+    uint64_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int k = 0; k < 4; ++k) {
+            uint64_t word;
+            std::memcpy(&word, bytes + i + 8 * k, sizeof(word));
+            lane[k] = (lane[k] ^ word) * MULTIPLIER;
+            lane[k] ^= lane[k] >> 29;
+        }
+    }
+    for (; i < size; ++i) lane[0] = (lane[0] ^ bytes[i]) * MULTIPLIER; // Tail: valid flags, odd counts.
+    uint64_t hash = lane[0];
+    for (int k = 1; k < 4; ++k) hash = (hash ^ (lane[k] >> 31) ^ lane[k]) * MULTIPLIER;
+    return hash ^ (hash >> 32);
+}
+
+bool writeAll(int fd, const void* data, uint64_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<uint64_t>(written);
+    }
+    return true;
+}
+
+SnapshotCommand toRecord(const Command& command) {
+    SnapshotCommand record{};
+    record.targetTick = command.targetTick;
+    record.type = static_cast<uint8_t>(command.type);
+    record.entity = command.entity;
+    record.value = command.value;
+    return record;
+}
+
+Command fromRecord(const SnapshotCommand& record) {
+    return Command{static_cast<CommandType>(record.type), record.value, record.targetTick, record.entity};
+}
+
+// Runs in the forked child. Only async-signal-safe-ish work: raw syscalls, no allocation, no stdio,
+// because other parent threads may have held locks at fork time.
+int writeSnapshotChild(const char* path, const SimulationState& sim, CommandQueue& pending,
+                       const CommandScheduler& scheduled, CommandRouter& router) {
+    // Static, not stack: ~1 MB in all. The child owns its copy.
+    static Command commands[MAX_SCHEDULED_COMMANDS];
+    static SnapshotCommand pendingRecords[MAX_PENDING_COMMANDS];
+    static SnapshotCommand scheduledRecords[MAX_WAITING_COMMANDS];
+
+    size_t pendingCount = pending.popBatch(commands, MAX_COMMAND_QUEUE_SIZE); // Child's private copy of the rings.
+    for (size_t i = 0; i < pendingCount; ++i) pendingRecords[i] = toRecord(commands[i]);
+    size_t scheduledCount = scheduled.copyPending(sim.tick, commands, MAX_SCHEDULED_COMMANDS);
+    for (size_t i = 0; i < scheduledCount; ++i) scheduledRecords[i] = toRecord(commands[i]);
+
+    for (size_t p = 0; p < router.partitionCount(); ++p) {
+        size_t n = router.queue(p).popBatch(commands, PARTITION_QUEUE_CAPACITY);
+        for (size_t i = 0; i < n; ++i) pendingRecords[pendingCount++] = toRecord(commands[i]);
+        n = router.scheduler(p).copyPending(sim.tick, commands, PARTITION_SCHEDULED_COMMANDS);
+        for (size_t i = 0; i < n; ++i) scheduledRecords[scheduledCount++] = toRecord(commands[i]);
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.entityCount = sim.current.size();
+    header.tick = sim.tick;
+    header.timeAccumulator = sim.timeAccumulator;
+    header.pendingCount = static_cast<uint32_t>(pendingCount);
+    header.scheduledCount = static_cast<uint32_t>(scheduledCount);
+
+    const SnapshotLayout layout = layoutFor(header.entityCount, pendingCount, scheduledCount);
+    const void* sections[SNAPSHOT_SECTIONS] = {
+        sim.current.position.data(), sim.current.velocity.data(), sim.current.valid.data(),
+        sim.previous.position.data(), sim.previous.velocity.data(), sim.previous.valid.data(),
+        pendingRecords, scheduledRecords
+    };
+    for (int i = 0; i < SNAPSHOT_SECTIONS; ++i) header.sectionChecksum[i] = checksum(sections[i], layout.size[i]);
+
+    char tmpPath[4096];
+    if (std::snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path) >= static_cast<int>(sizeof(tmpPath))) return 1;
+    int fd = ::open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return 1;
+
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    bool ok = writeAll(fd, &header, sizeof(header));
+    uint64_t position = sizeof(header);
+    for (int i = 0; ok && i < SNAPSHOT_SECTIONS; ++i) {
+        ok = writeAll(fd, zeros, layout.offset[i] - position) && writeAll(fd, sections[i], layout.size[i]);
+        position = layout.offset[i] + layout.size[i];
+    }
+    ok = ok && writeAll(fd, zeros, layout.fileSize - position);
+    ok = ok && ::fdatasync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    ok = ok && ::rename(tmpPath, path) == 0;     // Atomic publish: readers never see a half-written snapshot.
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+SnapshotWriter::~SnapshotWriter() {
+    wait();
+}
+
+bool SnapshotWriter::begin(const char* path, const SimulationState& sim, CommandQueue& pending,
+                           const CommandScheduler& scheduled, CommandRouter& router) {
+    poll();
+    if (child_ > 0) return false;                // Previous snapshot still being written; skip, don't queue up.
+
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        ++failed_;
+        return false;
+    }
+    if (pid == 0) {
+        ::_exit(writeSnapshotChild(path, sim, pending, scheduled, router)); // _exit: no atexit handlers, no parent buffers flushed twice.
+    }
+    child_ = pid;
+    return true;
+}
+
+void SnapshotWriter::poll() {
+    if (child_ <= 0) return;
+    int status = 0;
+    if (::waitpid(child_, &status, WNOHANG) == child_) reap(status);
+}
+
+void SnapshotWriter::wait() {
+    if (child_ <= 0) return;
+    int status = 0;
+    while (::waitpid(child_, &status, 0) < 0 && errno == EINTR) {
+    }
+    reap(status);
+}
+
+void SnapshotWriter::reap(int status) {
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) ++completed_;
+    else ++failed_;
+    child_ = -1;
+}
+
+bool restoreSnapshot(const char* path, SimulationState& sim, CommandQueue& pending, CommandScheduler& scheduled,
+                     CommandRouter& router, uint64_t& unrestored) {
+    unrestored = 0;
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<uint64_t>(info.st_size) < sizeof(SnapshotHeader)) {
+        ::close(fd);
+        return false;
+    }
+    const size_t fileSize = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);                                 // The mapping keeps the file alive.
+    if (mapping == MAP_FAILED) return false;
+    ::madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+    const char* base = static_cast<const char*>(mapping);
+    SnapshotHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    bool ok = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0
+              && header.version == SNAPSHOT_VERSION
+              && header.headerSize == sizeof(SnapshotHeader)
+              && header.pendingCount <= MAX_PENDING_COMMANDS
+              && header.scheduledCount <= MAX_WAITING_COMMANDS
+              && header.entityCount <= fileSize;  // Cheap sanity bound before computing the layout.
+
+    SnapshotLayout layout{};
+    if (ok) {
+        layout = layoutFor(header.entityCount, header.pendingCount, header.scheduledCount);
+        ok = layout.fileSize <= fileSize;
+    }
+    for (int i = 0; ok && i < SNAPSHOT_SECTIONS; ++i) { // Integrity of every section, before anything is copied.
+        ok = checksum(base + layout.offset[i], layout.size[i]) == header.sectionChecksum[i];
+    }
+
+    if (ok) {
+        const size_t count = static_cast<size_t>(header.entityCount);
+        auto section = [&](int i) { return base + layout.offset[i]; };
+        auto load = [&](EntityStore& store, int first) {
+            const Real* position = reinterpret_cast<const Real*>(section(first));
+            const Real* velocity = reinterpret_cast<const Real*>(section(first + 1));
+            const uint8_t* valid = reinterpret_cast<const uint8_t*>(section(first + 2));
+            store.position.assign(position, position + count);
+            store.velocity.assign(velocity, velocity + count);
+            store.valid.assign(valid, valid + count);
+        };
+        load(sim.current, 0);                    // Every section checked: from here on nothing can fail.
+        load(sim.previous, 3);
+        sim.activeBlocks.clear();                // Both described the state just replaced.
+        sim.blockTick.clear();
+        sim.tick = header.tick;
+        sim.timeAccumulator = header.timeAccumulator;
+
+        router.configure(count);                 // Partition geometry follows the restored world.
+        const SnapshotCommand* queued = reinterpret_cast<const SnapshotCommand*>(section(6));
+        for (uint32_t i = 0; i < header.pendingCount; ++i) {
+            if (queued[i].type > static_cast<uint8_t>(CommandType::Stop)) {
+                ++unrestored;
+                continue;
+            }
+            const Command command = fromRecord(queued[i]);
+            if (command.entity == ALL_ENTITIES) {
+                if (!pending.tryPush(command)) ++unrestored;
+            } else if (!router.enqueue(command)) {
+                ++unrestored;
+            }
+        }
+        const SnapshotCommand* waiting = reinterpret_cast<const SnapshotCommand*>(section(7));
+        for (uint32_t i = 0; i < header.scheduledCount; ++i) { // Release order in, so FIFO per tick is kept.
+            if (waiting[i].type > static_cast<uint8_t>(CommandType::Stop)) {
+                ++unrestored;
+                continue;
+            }
+            const Command command = fromRecord(waiting[i]);
+            const bool restored = command.entity == ALL_ENTITIES
+                                  ? scheduled.restore(command, sim.tick)  // Includes those due at sim.tick.
+                                  : router.restore(command, sim.tick);
+            if (!restored) ++unrestored;
+        }
+    }
+
+    ::munmap(mapping, fileSize);
+    return ok;
+}
@@ -0,0 +1,94 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <sys/types.h>
+
+#include "command_pipeline.h"
+#include "simulation.h"
+
+// Snapshot/restore of the full engine state: current and previous stores, time accumulator,
+// tick counter, the commands still pending in the ingestion queues and those waiting in the schedulers
+// (broadcast and per-partition).
+//
+// Taking a snapshot never stalls the tick loop: the sim thread fork()s, and the child process
+// serializes its copy-on-write view of memory while the parent keeps ticking. The parent pays for
+// the fork itself (page-table copy) and for COW faults on pages it dirties while the child runs;
+// neither scales with I/O time. The child writes to PATH.tmp and renames, so PATH is always complete.
+//
+// Restore mmap()s the file and copies the sections straight into the stores; no parsing, one memcpy
+// per array. That is O(state), not a zero-copy mapping: the stores own their vectors. The header
+// carries a checksum of every section, verified on the mapping before anything is copied, so a corrupt
+// or truncated file is rejected whichever section is hit.
+//
+// File layout (host byte order): SnapshotHeader, then 64-byte-aligned sections
+//   current.position, current.velocity, current.valid, previous.position, previous.velocity,
+//   previous.valid, queued commands, scheduled commands (both SnapshotCommand records: the broadcast
+//   queue/scheduler first, then each partition's in partition order; scheduled ones in release order).
+
+#ifdef SIM_FIXED_POINT
+const char SNAPSHOT_MAGIC[4] = {'C', '2', 'S', 'Q'}; // Q32.32 state: a double build must not load it, nor vice versa.
+#else
+const char SNAPSHOT_MAGIC[4] = {'C', '2', 'S', 'N'};
+#endif
+const uint16_t SNAPSHOT_VERSION = 4;             // 2: commands carry targetTick; scheduler contents saved. 3: target entity.
+                                                 // 4: per-section checksums replace the world hash.
+const int SNAPSHOT_SECTIONS = 8;                 // In file order, as listed above.
+
+struct SnapshotHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint64_t entityCount;
+    uint64_t tick;
+    double timeAccumulator;
+    uint32_t pendingCount;                       // Commands that were queued but not yet consumed.
+    uint32_t scheduledCount;                     // Commands drained but waiting in the scheduler for a later tick.
+    uint64_t sectionChecksum[SNAPSHOT_SECTIONS]; // Over each section's bytes (padding excluded); verified on restore.
+};
+
+struct SnapshotCommand {                         // Explicit on-disk form of a Command.
+    uint64_t targetTick;
+    uint8_t type;
+    uint8_t reserved[3];
+    uint32_t entity;
+    double value;
+};
+
+static_assert(sizeof(SnapshotHeader) == 104, "snapshot header layout changed");
+static_assert(sizeof(SnapshotCommand) == 24, "snapshot command layout changed");
+
+class SnapshotWriter {
+public:
+    SnapshotWriter() = default;
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Forks a child that writes the snapshot. Returns false if one is still being written (skipped)
+    // or fork failed. Sim thread only; call between steps so the state is consistent.
+    bool begin(const char* path, const SimulationState& sim, CommandQueue& pending, const CommandScheduler& scheduled,
+               CommandRouter& router);
+    void poll();                                 // Reaps a finished child without blocking.
+    void wait();                                 // Blocks until the current child (if any) is done. Shutdown only.
+    bool inProgress() const { return child_ > 0; }
+    uint64_t completed() const { return completed_; }
+    uint64_t failed() const { return failed_; }
+
+private:
+    void reap(int status);
+
+    pid_t child_ = -1;
+    uint64_t completed_ = 0;
+    uint64_t failed_ = 0;
+};
+
+// Loads a snapshot into sim, re-queues its pending commands and re-schedules its scheduled ones (targeted
+// ones through router, which is configured for the snapshot's entity count). Queues and schedulers must
+// be empty. False (and sim untouched) on any mismatch. Commands that could not be put back (a full queue
+// or wheel, an unknown type) are counted in unrestored rather than dropped silently.
+bool restoreSnapshot(const char* path, SimulationState& sim, CommandQueue& pending, CommandScheduler& scheduled,
+                     CommandRouter& router, uint64_t& unrestored);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,65 @@
+#include "state_hash.h"
+
+namespace {
+
+const size_t HASH_LOG_BUFFER_BYTES = 1 << 20;
+
+uint64_t mix64(uint64_t x) {                     // MurmurHash3 fmix64: full avalanche.
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+} // namespace
+
+uint64_t finishBlockHash(const HashAccumulator& acc, size_t count) {
+    uint64_t h = mix64(count);
+    h = mix64(h ^ acc.position);                 // Streams folded separately: swapping fields changes the hash.
+    h = mix64(h ^ acc.velocity);
+    return mix64(h ^ acc.valid);
+}
+
+uint64_t hashCombine(uint64_t tickHash, uint64_t blockHash, size_t blockIndex) {
+    return mix64(tickHash ^ (blockHash + blockIndex * 0x9E3779B97F4A7C15ULL));
+}
+
+uint64_t hashBlock(const Real* position, const Real* velocity, const uint8_t* valid, size_t count) {
+    HashAccumulator acc;
+    for (size_t i = 0; i < count; ++i) {
+        hashEntity(position[i], velocity[i], valid[i], static_cast<uint32_t>(i), acc);
+    }
+    return finishBlockHash(acc, count);
+}
+
+HashLogWriter::~HashLogWriter() {
+    close();
+}
+
+bool HashLogWriter::open(const char* path) {
+    file_ = std::fopen(path, "wb");
+    if (!file_) return false;
+    buffer_.resize(HASH_LOG_BUFFER_BYTES);
+    std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+
+    HashLogHeader header;
+    std::memcpy(header.magic, HASH_LOG_MAGIC, sizeof(header.magic));
+    header.version = HASH_LOG_VERSION;
+    header.recordSize = sizeof(HashLogRecord);
+    std::fwrite(&header, sizeof(header), 1, file_);
+    return true;
+}
+
+void HashLogWriter::append(uint64_t tick, uint64_t hash) {
+    if (!file_) return;
+    HashLogRecord record{tick, hash};
+    std::fwrite(&record, sizeof(record), 1, file_);
+}
+
+void HashLogWriter::close() {
+    if (!file_) return;
+    std::fclose(file_);
+    file_ = nullptr;
+}
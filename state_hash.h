@@ -0,0 +1,105 @@
+#ifndef STATE_HASH_H
+#define STATE_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "numeric.h"
+
+// Per-tick state hashing for divergence detection between redundant replicas.
+//
+// Hash definition. Within a block, entity i (local index) contributes three NH-style terms
+// (UMAC family: 32x32->64 multiply of keyed halves, summed mod 2^64):
+//   position: (lo32(bits(p)) + KP_LO + i*S_LO) * (hi32(bits(p)) + KP_HI + i*S_HI)
+//   velocity: (lo32(bits(v)) + KV_LO + i*S_LO) * (hi32(bits(v)) + KV_HI + i*S_HI)
+//   valid:    valid * (KP_LO + i*S_LO)
+// The key depends on the entity index, not on a SIMD lane, so the sums are the same whatever the
+// vector width and order of accumulation. Scalar, AVX2 and AVX-512 kernels give identical hashes
+// and replicas on different CPUs stay comparable. Each term maps onto one vpmuludq.
+//
+// Cost. The terms are accumulated inside the integration kernels (see integrator.h) on values
+// already in registers, so hashing adds a few ALU ops to a memory-bound loop and no extra memory traffic.
+// Block sums are finalized and folded in block order into the tick hash, so the result never
+// depends on how the blocks were scheduled.
+//
+// Purpose is accidental-divergence detection, not tamper resistance.
+
+const size_t HASH_BLOCK_ENTITIES = 4096;         // Unit of folding (and later of parallel work).
+const uint64_t HASH_SEED = 0x43325348415348ULL;  // Initial tick hash ("C2SHASH").
+
+const uint32_t HASH_KEY_POSITION_LO = 0x9E3779B1u; // Fixed keys; part of the hash definition, never change.
+const uint32_t HASH_KEY_POSITION_HI = 0x85EBCA77u;
+const uint32_t HASH_KEY_VELOCITY_LO = 0xC2B2AE3Du;
+const uint32_t HASH_KEY_VELOCITY_HI = 0x27D4EB2Fu;
+const uint32_t HASH_STRIDE_LO = 0x165667B1u;     // Per-index key increments.
+const uint32_t HASH_STRIDE_HI = 0xFD7046C5u;
+
+struct HashAccumulator {                         // Running sums for one block.
+    uint64_t position = 0;
+    uint64_t velocity = 0;
+    uint64_t valid = 0;
+};
+
+inline uint64_t hashTerm(uint64_t bits, uint32_t keyLo, uint32_t keyHi) {
+    uint32_t lo = static_cast<uint32_t>(bits) + keyLo;
+    uint32_t hi = static_cast<uint32_t>(bits >> 32) + keyHi;
+    return static_cast<uint64_t>(lo) * hi;
+}
+
+inline void hashEntity(Real position, Real velocity, uint8_t valid, uint32_t index, HashAccumulator& acc) {
+    uint64_t positionBits;
+    uint64_t velocityBits;
+    std::memcpy(&positionBits, &position, sizeof(positionBits)); // Raw bits: -0.0 and 0.0 differ, as they should.
+    std::memcpy(&velocityBits, &velocity, sizeof(velocityBits));
+    uint32_t strideLo = index * HASH_STRIDE_LO;
+    uint32_t strideHi = index * HASH_STRIDE_HI;
+    acc.position += hashTerm(positionBits, HASH_KEY_POSITION_LO + strideLo, HASH_KEY_POSITION_HI + strideHi);
+    acc.velocity += hashTerm(velocityBits, HASH_KEY_VELOCITY_LO + strideLo, HASH_KEY_VELOCITY_HI + strideHi);
+    acc.valid += static_cast<uint64_t>(valid) * static_cast<uint32_t>(HASH_KEY_POSITION_LO + strideLo);
+}
+
+uint64_t finishBlockHash(const HashAccumulator& acc, size_t count); // Avalanche the block sums.
+uint64_t hashCombine(uint64_t tickHash, uint64_t blockHash, size_t blockIndex); // Order-sensitive fold.
+uint64_t hashBlock(const Real* position, const Real* velocity, const uint8_t* valid, size_t count); // Standalone (no integration).
+
+// Checksum stream: one {tick, hash} record per tick, written through a large stdio buffer.
+// Compare two streams with tools/hash_diff to find the first diverging tick.
+const char HASH_LOG_MAGIC[4] = {'C', '2', 'S', 'H'};
+const uint16_t HASH_LOG_VERSION = 1;
+
+struct HashLogHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;
+};
+
+struct HashLogRecord {
+    uint64_t tick;                               // sim.tick after the step, i.e. the state this hash describes.
+    uint64_t hash;
+};
+
+static_assert(sizeof(HashLogHeader) == 8, "hash log header layout changed");
+static_assert(sizeof(HashLogRecord) == 16, "hash log record layout changed");
+
+class HashLogWriter {
+public:
+    HashLogWriter() = default;
+    ~HashLogWriter();
+
+    HashLogWriter(const HashLogWriter&) = delete;
+    HashLogWriter& operator=(const HashLogWriter&) = delete;
+
+    bool open(const char* path);
+    bool isOpen() const { return file_ != nullptr; }
+    void append(uint64_t tick, uint64_t hash);   // Sim thread, once per step. Buffered.
+    void close();
+
+private:
+    std::FILE* file_ = nullptr;
+    std::vector<char> buffer_;
+};
+
+#endif // STATE_HASH_H
@@ -0,0 +1,62 @@
+#include "telemetry.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace {
+const size_t WRITER_BATCH = 256;                 // Records per fwrite; one syscall-sized chunk (~10 KB).
+const std::chrono::milliseconds WRITER_IDLE_SLEEP(2); // Back-off when the ring is empty; latency is irrelevant here.
+}
+
+TelemetrySink::~TelemetrySink() {
+    close();
+}
+
+bool TelemetrySink::open(const char* path) {
+    close();
+    if (std::strcmp(path, "-") == 0) {
+        file_ = stdout;
+        ownsFile_ = false;
+    } else {
+        file_ = std::fopen(path, "wb");
+        ownsFile_ = true;
+    }
+    if (!file_) return false;
+
+    TelemetryFileHeader header;
+    std::memcpy(header.magic, TELEMETRY_MAGIC, sizeof(header.magic));
+    header.version = TELEMETRY_VERSION;
+    header.recordSize = sizeof(TelemetryRecord);
+    std::fwrite(&header, sizeof(header), 1, file_);
+
+    running_.store(true, std::memory_order_release);
+    writer_ = std::thread(&TelemetrySink::writerLoop, this);
+    return true;
+}
+
+void TelemetrySink::close() {
+    if (writer_.joinable()) {
+        running_.store(false, std::memory_order_release);
+        writer_.join();                          // Writer drains the ring before returning.
+    }
+    if (file_) {
+        std::fflush(file_);
+        if (ownsFile_) std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void TelemetrySink::writerLoop() {
+    TelemetryRecord batch[WRITER_BATCH];
+    for (;;) {
+        bool stopping = !running_.load(std::memory_order_acquire); // Sample before draining so nothing published earlier is lost.
+        size_t count = ring_.popBatch(batch, WRITER_BATCH);
+        if (count > 0) {
+            std::fwrite(batch, sizeof(TelemetryRecord), count, file_);
+            if (count < WRITER_BATCH) std::fflush(file_); // Ring caught up: push data to the pipe/file reader now.
+            continue;
+        }
+        if (stopping) break;
+        std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "command_queue.h"
+
+// Asynchronous binary telemetry: the presenter thread (presentation.h) copies interpolated state into a
+// lock-free ring, a background writer thread drains it in batches to a file or pipe. Nothing upstream
+// formats, flushes or waits on I/O; if the writer falls behind, records are dropped and counted.
+//
+// Wire format (host byte order, little-endian on all supported targets):
+//   TelemetryFileHeader once, then a stream of fixed-size TelemetryRecord.
+// Use tools/telemetry_decode to turn a capture into human-readable text.
+
+const char TELEMETRY_MAGIC[4] = {'C', '2', 'T', 'L'};
+const uint16_t TELEMETRY_VERSION = 2;                // 2: timestamps in ns (were whole ms).
+const size_t TELEMETRY_RING_CAPACITY = 4096;     // ~40 s of history at 60 fps for one track; absorbs disk hiccups.
+
+struct TelemetryFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t recordSize;                         // Lets readers reject or skip records from a newer layout.
+};
+
+struct TelemetryRecord {                         // 40 bytes, naturally aligned; written verbatim.
+    int64_t timeNs;                              // Frame timestamp from the run's Clock.
+    int64_t dtNs;                                // Measured (unclamped) frame delta.
+    uint32_t entity;                             // Entity index in the EntityStore.
+    uint8_t valid;
+    uint8_t reserved[3];
+    double position;                             // Interpolated (presentation) values.
+    double velocity;
+};
+
+static_assert(sizeof(TelemetryFileHeader) == 8, "telemetry header layout changed");
+static_assert(sizeof(TelemetryRecord) == 40, "telemetry record layout changed");
+
+class TelemetrySink {
+public:
+    TelemetrySink() = default;
+    ~TelemetrySink();
+
+    TelemetrySink(const TelemetrySink&) = delete;
+    TelemetrySink& operator=(const TelemetrySink&) = delete;
+
+    bool open(const char* path);                 // "-" writes to stdout (for piping). Starts the writer thread.
+    void close();                                // Drains what is queued, stops the writer, closes the file.
+
+    bool publish(const TelemetryRecord& record) { // One producer thread. Wait-free; false = ring full, record dropped.
+        if (ring_.tryPush(record)) return true;
+        ++dropped_;
+        return false;
+    }
+
+    uint64_t dropped() const { return dropped_; } // Producer thread only.
+
+private:
+    void writerLoop();
+
+    MpscRingBuffer<TelemetryRecord, TELEMETRY_RING_CAPACITY> ring_; // Used single-producer here; same lock-free ring as commands.
+    std::FILE* file_ = nullptr;
+    bool ownsFile_ = false;
+    std::thread writer_;
+    std::atomic<bool> running_{false};
+    uint64_t dropped_ = 0;
+};
+
+#endif // TELEMETRY_H
@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../command_pipeline.h"
+#include "../job_system.h"
+#include "../simulation.h"
+#include "../snapshot.h"
+
+// Checks that fast-forward (SimulationState::fastForward) never changes results. Two worlds step the same
+// seeded command stream, one deferring idle blocks and one stepping every block every tick:
+//   - broadcasts (Accelerate and Stop) and targeted commands, sorted by entity as stepSimulation takes them;
+//   - entities dying along the way, so the active set shrinks under the deferral;
+//   - syncEntities on random watch-lists (the presentation path), compared entity by entity;
+//   - syncState, compared by hashState of both stores;
+//   - a stretch with hashEnabled, compared by stateHash every tick;
+//   - a snapshot of the stepping world restored into the deferring one halfway through.
+// Usage: fast_forward_check [--ticks N] [--threads N] [--seed N] [--snapshot-path PATH]
+// Exit code 0 = identical at every sync point, 1 = diverged, 2 = error.
+
+namespace {
+
+const size_t CHECK_ENTITIES = 9 * ENTITY_BLOCK_SIZE + 123; // Several blocks plus a partial one.
+const uint64_t SYNC_STATE_EVERY = 97;            // Ticks between full syncs; coprime with the lag limit.
+const uint64_t SYNC_ENTITIES_EVERY = 13;         // Ticks between watch-list syncs.
+const uint64_t HASH_WINDOW = 40;                 // Ticks stepped with hashEnabled, starting at ticks / 4.
+
+struct Options {
+    uint64_t ticks = 2000;
+    unsigned threads = 1;
+    uint64_t seed = 1;
+    const char* snapshotPath = "fast_forward_check.c2s";
+};
+
+EntityStore initialWorld(std::mt19937_64& rng) {
+    EntityStore world(CHECK_ENTITIES, SystemState{0.0, 1.0, true});
+    for (size_t i = 0; i < CHECK_ENTITIES; ++i) {
+        const bool dying = (i / ENTITY_BLOCK_SIZE) % 3 == 0 || rng() % 4 == 0; // Clustered and scattered deaths.
+        const double speed = static_cast<double>(rng() % 1000) / 100.0;
+        world.set(i, SystemState{static_cast<double>(rng() % 2000) / 10.0, dying ? -speed : speed, rng() % 40 != 0});
+    }
+    return world;
+}
+
+void makeCommands(std::mt19937_64& rng, std::vector<Command>& broadcast, std::vector<Command>& targeted) {
+    broadcast.clear();
+    targeted.clear();
+    if (rng() % 16 == 0) broadcast.push_back(Command{CommandType::Accelerate, static_cast<double>(rng() % 100) / 50.0 - 1.0});
+    if (rng() % 300 == 0) broadcast.push_back(Command{CommandType::Stop, 0.0});
+    const size_t count = rng() % 8;              // Most blocks get none: those are the ones deferred.
+    for (size_t i = 0; i < count; ++i) {
+        Command command{rng() % 6 == 0 ? CommandType::Stop : CommandType::Accelerate,
+                        static_cast<double>(rng() % 1000) / 100.0 - 5.0};
+        command.entity = static_cast<uint32_t>(rng() % CHECK_ENTITIES);
+        targeted.push_back(command);
+    }
+    std::stable_sort(targeted.begin(), targeted.end(),
+                     [](const Command& a, const Command& b) { return a.entity < b.entity; });
+}
+
+bool sameEntities(const EntityStore& a, const EntityStore& b, const std::vector<uint32_t>& entities) {
+    for (uint32_t e : entities) {                // Bits, not ==: -0.0 and 0.0 must not compare equal here.
+        if (std::memcmp(&a.position[e], &b.position[e], sizeof(Real)) != 0
+            || std::memcmp(&a.velocity[e], &b.velocity[e], sizeof(Real)) != 0 || a.valid[e] != b.valid[e]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool report(bool ok, const char* what, uint64_t tick) {
+    if (!ok) std::printf("diverged at tick %llu: %s\n", static_cast<unsigned long long>(tick), what);
+    return ok;
+}
+
+bool snapshotAndRestore(const char* path, SimulationState& source, SimulationState& target, JobSystem* jobs) {
+    static CommandQueue pending;                 // Nothing is ever queued here: empty on save, empty for restore.
+    static CommandScheduler scheduled;
+    static CommandRouter router;
+    router.configure(CHECK_ENTITIES);
+    syncState(source, jobs);
+    SnapshotWriter writer;                       // Same fork-and-write path as main's checkpoints.
+    if (!writer.begin(path, source, pending, scheduled, router)) return false;
+    writer.wait();
+    uint64_t unrestored = 0;
+    const bool ok = writer.completed() == 1 && restoreSnapshot(path, target, pending, scheduled, router, unrestored)
+                    && unrestored == 0;
+    std::remove(path);
+    return ok;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            options.ticks = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--snapshot-path") == 0 && i + 1 < argc) {
+            options.snapshotPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: fast_forward_check [--ticks N] [--threads N] [--seed N] [--snapshot-path PATH]\n");
+            return 2;
+        }
+    }
+
+    JobSystem pool(options.threads);
+    JobSystem* jobs = pool.threadCount() > 1 ? &pool : nullptr;
+    std::mt19937_64 rng(options.seed);
+    const EntityStore world = initialWorld(rng);
+    SimulationState deferring(world);
+    SimulationState stepping(world);
+    deferring.fastForward = true;
+
+    std::vector<Command> broadcast;
+    std::vector<Command> targeted;
+    std::vector<uint32_t> watch;
+    const uint64_t hashStart = options.ticks / 4;
+    const uint64_t restoreTick = options.ticks / 2;
+    bool ok = true;
+    for (uint64_t t = 0; t < options.ticks && ok; ++t) {
+        const bool hashing = t >= hashStart && t < hashStart + HASH_WINDOW;
+        deferring.hashEnabled = hashing;
+        stepping.hashEnabled = hashing;
+        makeCommands(rng, broadcast, targeted);
+        stepSimulation(deferring, broadcast.data(), broadcast.size(), targeted.data(), targeted.size(), jobs);
+        stepSimulation(stepping, broadcast.data(), broadcast.size(), targeted.data(), targeted.size(), jobs);
+        const uint64_t tick = stepping.tick;
+        ok = report(deferring.tick == tick, "tick counters differ", tick);
+        if (ok && hashing) ok = report(deferring.stateHash == stepping.stateHash, "stateHash", tick);
+
+        if (ok && tick % SYNC_ENTITIES_EVERY == 0) {
+            watch.clear();                       // A viewport (one run) plus scattered tracks, sorted and unique.
+            const uint32_t first = static_cast<uint32_t>(rng() % CHECK_ENTITIES);
+            for (uint32_t e = first; e < CHECK_ENTITIES && e < first + 64; ++e) watch.push_back(e);
+            for (int i = 0; i < 16; ++i) watch.push_back(static_cast<uint32_t>(rng() % CHECK_ENTITIES));
+            std::sort(watch.begin(), watch.end());
+            watch.erase(std::unique(watch.begin(), watch.end()), watch.end());
+            syncEntities(deferring, watch.data(), watch.size());
+            ok = report(sameEntities(deferring.current, stepping.current, watch), "syncEntities current", tick)
+                 && report(sameEntities(deferring.previous, stepping.previous, watch), "syncEntities previous", tick);
+        }
+        if (ok && tick % SYNC_STATE_EVERY == 0) {
+            syncState(deferring, jobs);
+            ok = report(hashState(deferring.current) == hashState(stepping.current), "syncState current", tick)
+                 && report(hashState(deferring.previous) == hashState(stepping.previous), "syncState previous", tick);
+        }
+        if (ok && tick == restoreTick) {
+            if (!snapshotAndRestore(options.snapshotPath, stepping, deferring, jobs)) {
+                std::fprintf(stderr, "fast_forward_check: snapshot round trip via %s failed\n", options.snapshotPath);
+                return 2;
+            }
+            ok = report(hashState(deferring.current) == hashState(stepping.current), "restore", tick);
+        }
+    }
+    if (ok) {
+        syncState(deferring, jobs);
+        ok = report(hashState(deferring.current) == hashState(stepping.current), "final syncState", stepping.tick)
+             && report(hashState(deferring.previous) == hashState(stepping.previous), "final syncState previous", stepping.tick);
+    }
+    if (!ok) return 1;
+    std::printf("identical (%llu ticks, %zu entities, %u threads, seed %llu)\n",
+                static_cast<unsigned long long>(options.ticks), CHECK_ENTITIES, pool.threadCount(),
+                static_cast<unsigned long long>(options.seed));
+    return 0;
+}
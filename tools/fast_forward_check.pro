@@ -0,0 +1,27 @@
+TEMPLATE = app
+TARGET = fast_forward_check
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += thread
+
+# Same code generation as the engine: the check compares the code that ships.
+!msvc: QMAKE_CXXFLAGS += -ffp-contract=off
+fixed_point: DEFINES += SIM_FIXED_POINT
+
+SOURCES += \
+    fast_forward_check.cpp \
+    ../clock.cpp \
+    ../command_pipeline.cpp \
+    ../integrator.cpp \
+    ../job_system.cpp \
+    ../simulation.cpp \
+    ../snapshot.cpp \
+    ../state_hash.cpp \
+    ../trace.cpp
+
+HEADERS += \
+    ../command_pipeline.h \
+    ../job_system.h \
+    ../simulation.h \
+    ../snapshot.h
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <cstring>
+
+#include "../state_hash.h"
+
+// Compares two per-tick checksum streams (--hash-log) from redundant replicas or a run and its replay.
+// Reports the first tick whose state hash differs. Records are matched by tick, not by position: a
+// stream that starts later (a --restore run) is compared from the first tick both streams hold. After
+// that the ticks must advance together; a tick missing from one stream is reported as a gap, not as
+// divergence. Both streams are read sequentially, so the cost is one pass over the files.
+// Usage: hash_diff a.hash b.hash     exit code 0 = identical, 1 = diverged, 2 = error (including a gap)
+
+namespace {
+
+const size_t BATCH = 4096;                       // Records per fread.
+
+std::FILE* openHashLog(const char* path) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) {
+        std::fprintf(stderr, "hash_diff: cannot open %s\n", path);
+        return nullptr;
+    }
+    HashLogHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1
+        || std::memcmp(header.magic, HASH_LOG_MAGIC, sizeof(header.magic)) != 0
+        || header.version != HASH_LOG_VERSION || header.recordSize != sizeof(HashLogRecord)) {
+        std::fprintf(stderr, "hash_diff: %s is not a supported hash log\n", path);
+        std::fclose(file);
+        return nullptr;
+    }
+    return file;
+}
+
+class HashLogStream {                            // Sequential, batched reader over one log's records.
+public:
+    explicit HashLogStream(std::FILE* file) : file_(file) {}
+    ~HashLogStream() { std::fclose(file_); }
+
+    HashLogStream(const HashLogStream&) = delete;
+    HashLogStream& operator=(const HashLogStream&) = delete;
+
+    bool next(HashLogRecord& record) {           // False at end of stream.
+        if (index_ == count_) {
+            count_ = std::fread(records_, sizeof(HashLogRecord), BATCH, file_);
+            index_ = 0;
+            if (count_ == 0) return false;
+        }
+        record = records_[index_++];
+        return true;
+    }
+
+private:
+    std::FILE* file_;
+    HashLogRecord records_[BATCH];
+    size_t count_ = 0;
+    size_t index_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: hash_diff A.hash B.hash\n");
+        return 2;
+    }
+    std::FILE* fa = openHashLog(argv[1]);
+    std::FILE* fb = openHashLog(argv[2]);
+    if (!fa || !fb) {
+        if (fa) std::fclose(fa);
+        if (fb) std::fclose(fb);
+        return 2;
+    }
+    static HashLogStream a(fa);                  // Static: 64 KB of buffer each.
+    static HashLogStream b(fb);
+
+    HashLogRecord ra;
+    HashLogRecord rb;
+    bool moreA = a.next(ra);
+    bool moreB = b.next(rb);
+    while (moreA && moreB && ra.tick != rb.tick) { // Skip to the first tick both streams hold.
+        if (ra.tick < rb.tick) moreA = a.next(ra);
+        else moreB = b.next(rb);
+    }
+    if (!moreA || !moreB) {
+        std::fprintf(stderr, "hash_diff: %s and %s have no tick in common\n", argv[1], argv[2]);
+        return 2;
+    }
+
+    const unsigned long long firstTick = ra.tick;
+    unsigned long long compared = 0;
+    while (moreA && moreB) {
+        if (ra.tick != rb.tick) {
+            std::fprintf(stderr, "hash_diff: tick gap after %llu ticks: %s has tick %llu where %s has %llu\n",
+                         compared, argv[1], static_cast<unsigned long long>(ra.tick), argv[2],
+                         static_cast<unsigned long long>(rb.tick));
+            return 2;
+        }
+        if (ra.hash != rb.hash) {
+            std::printf("diverged at tick %llu: %016llx vs %016llx\n", static_cast<unsigned long long>(ra.tick),
+                        static_cast<unsigned long long>(ra.hash), static_cast<unsigned long long>(rb.hash));
+            return 1;
+        }
+        ++compared;
+        moreA = a.next(ra);
+        moreB = b.next(rb);
+    }
+
+    if (moreA != moreB) {
+        std::printf("identical for %llu ticks from tick %llu; %s is longer\n", compared, firstTick,
+                    moreA ? argv[1] : argv[2]);
+    } else {
+        std::printf("identical (%llu ticks from tick %llu)\n", compared, firstTick);
+    }
+    return 0;
+}
@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = hash_diff
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+    hash_diff.cpp
+
+HEADERS += \
+    ../state_hash.h
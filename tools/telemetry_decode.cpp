@@ -0,0 +1,41 @@
+#include <cstdio>
+#include <cstring>
+
+#include "../telemetry.h"
+
+// Offline decoder for TelemetrySink captures. Prints one line per record in the same shape the
+// engine used to write to stdout, so existing eyeballing habits and grep scripts keep working.
+// Usage: telemetry_decode [capture.bin]   (reads stdin when no file is given, e.g. engine | telemetry_decode)
+
+int main(int argc, char* argv[]) {
+    std::FILE* in = stdin;
+    if (argc > 1 && std::strcmp(argv[1], "-") != 0) {
+        in = std::fopen(argv[1], "rb");
+        if (!in) {
+            std::fprintf(stderr, "telemetry_decode: cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+
+    TelemetryFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, in) != 1
+        || std::memcmp(header.magic, TELEMETRY_MAGIC, sizeof(header.magic)) != 0) {
+        std::fprintf(stderr, "telemetry_decode: not a telemetry capture\n");
+        return 1;
+    }
+    if (header.version != TELEMETRY_VERSION || header.recordSize != sizeof(TelemetryRecord)) {
+        std::fprintf(stderr, "telemetry_decode: unsupported version %u (record size %u)\n",
+                     static_cast<unsigned>(header.version), static_cast<unsigned>(header.recordSize));
+        return 1;
+    }
+
+    TelemetryRecord record;
+    while (std::fread(&record, sizeof(record), 1, in) == 1) {
+        std::printf("t =%.3fms dt=%.3f entity=%u pos=%g vel=%g valid=%u\n",
+                    record.timeNs / 1e6, record.dtNs / 1e6,
+                    record.entity, record.position, record.velocity, static_cast<unsigned>(record.valid));
+    }
+
+    if (in != stdin) std::fclose(in);
+    return 0;
+}
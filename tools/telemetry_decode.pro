@@ -0,0 +1,11 @@
+TEMPLATE = app
+TARGET = telemetry_decode
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+
+SOURCES += \
+    telemetry_decode.cpp
+
+HEADERS += \
+    ../telemetry.h
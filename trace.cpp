@@ -0,0 +1,126 @@
+#include "trace.h"
+
+#include <cstdio>
+#include <vector>
+
+#include "command_queue.h"
+
+namespace trace_detail {
+
+std::atomic<bool> enabled{false};
+Clock* clock = nullptr;
+
+} // namespace trace_detail
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t beginNs;
+    int64_t endNs;
+};
+
+struct alignas(CACHE_LINE_SIZE) TraceRing {      // One per thread; written only by its owner.
+    std::atomic<uint64_t> head{0};               // Events ever written; slot = index % capacity.
+    uint32_t tid = 0;
+    char name[32] = {};
+    TraceEvent events[TRACE_RING_CAPACITY];
+};
+
+SteadyClock defaultClock;
+std::atomic<TraceRing*> rings[MAX_TRACE_THREADS] = {};
+std::atomic<size_t> ringsClaimed{0};
+thread_local TraceRing* localRing = nullptr;
+thread_local bool localRingRefused = false;      // Past MAX_TRACE_THREADS: this thread is silently untraced.
+
+TraceRing* ringForThisThread() {
+    if (localRing || localRingRefused) return localRing;
+    const size_t slot = ringsClaimed.fetch_add(1, std::memory_order_relaxed);
+    if (slot >= MAX_TRACE_THREADS) {
+        localRingRefused = true;
+        return nullptr;
+    }
+    TraceRing* ring = new TraceRing();           // Once per thread, never freed: a dump may outlive the thread.
+    ring->tid = static_cast<uint32_t>(slot + 1);
+    std::snprintf(ring->name, sizeof(ring->name), "thread %zu", slot + 1);
+    rings[slot].store(ring, std::memory_order_release);
+    localRing = ring;
+    return ring;
+}
+
+} // namespace
+
+void trace_detail::record(const char* name, int64_t beginNs, int64_t endNs) {
+    TraceRing* ring = localRing ? localRing : ringForThisThread();
+    if (!ring) return;
+    const uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head % TRACE_RING_CAPACITY] = TraceEvent{name, beginNs, endNs};
+    ring->head.store(head + 1, std::memory_order_release); // Publishes the event to traceDump().
+}
+
+void traceEnable(Clock* clock) {
+    trace_detail::clock = clock ? clock : &defaultClock;
+    trace_detail::enabled.store(true, std::memory_order_relaxed);
+}
+
+bool traceEnabled() {
+    return trace_detail::enabled.load(std::memory_order_relaxed);
+}
+
+void traceThreadName(const char* name) {
+    if (TraceRing* ring = ringForThisThread()) std::snprintf(ring->name, sizeof(ring->name), "%s", name);
+}
+
+bool traceDump(const char* path) {
+    struct ThreadEvents {
+        const TraceRing* ring;
+        std::vector<TraceEvent> events;
+    };
+    std::vector<ThreadEvents> threads;
+    int64_t originNs = INT64_MAX;
+
+    size_t claimed = ringsClaimed.load(std::memory_order_relaxed);
+    if (claimed > MAX_TRACE_THREADS) claimed = MAX_TRACE_THREADS;
+    for (size_t slot = 0; slot < claimed; ++slot) {
+        const TraceRing* ring = rings[slot].load(std::memory_order_acquire);
+        if (!ring) continue;                     // Claimed but not published yet.
+
+        const uint64_t headBefore = ring->head.load(std::memory_order_acquire);
+        const uint64_t first = headBefore > TRACE_RING_CAPACITY ? headBefore - TRACE_RING_CAPACITY : 0;
+        std::vector<TraceEvent> copy;
+        copy.reserve(static_cast<size_t>(headBefore - first));
+        for (uint64_t i = first; i < headBefore; ++i) copy.push_back(ring->events[i % TRACE_RING_CAPACITY]);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t headAfter = ring->head.load(std::memory_order_relaxed);
+
+        // The owner may have lapped us while copying; slots at or below headAfter - capacity were reused.
+        uint64_t firstIntact = headAfter + 1 > TRACE_RING_CAPACITY ? headAfter + 1 - TRACE_RING_CAPACITY : 0;
+        if (firstIntact < first) firstIntact = first;
+        ThreadEvents thread{ring, {}};
+        if (firstIntact < headBefore) {
+            thread.events.assign(copy.begin() + static_cast<std::ptrdiff_t>(firstIntact - first), copy.end());
+        }
+        for (const TraceEvent& event : thread.events) {
+            if (event.beginNs < originNs) originNs = event.beginNs;
+        }
+        threads.push_back(std::move(thread));
+    }
+    if (originNs == INT64_MAX) originNs = 0;
+
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", file);
+    bool firstRecord = true;
+    for (const ThreadEvents& thread : threads) {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                     firstRecord ? "" : ",\n", thread.ring->tid, thread.ring->name);
+        firstRecord = false;
+        for (const TraceEvent& event : thread.events) { // Complete ("X") events; ts/dur in us with ns precision.
+            std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         event.name, thread.ring->tid, (event.beginNs - originNs) / 1000.0,
+                         (event.endNs - event.beginNs) / 1000.0);
+        }
+    }
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}